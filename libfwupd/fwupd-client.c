@@ -2623,6 +2623,125 @@ fwupd_client_get_upgrades_finish(FwupdClient *self, GAsyncResult *res, GError **
 	return g_task_propagate_pointer(G_TASK(res), error);
 }
 
+static GHashTable *
+fwupd_client_upgrades_hash_from_variant(GVariant *value, GError **error)
+{
+	gsize sz;
+	g_autoptr(GHashTable) hash = NULL;
+	g_autoptr(GVariant) untuple = NULL;
+
+	hash = g_hash_table_new_full(g_str_hash,
+				     g_str_equal,
+				     g_free,
+				     (GDestroyNotify)g_ptr_array_unref);
+	untuple = g_variant_get_child_value(value, 0);
+	sz = g_variant_n_children(untuple);
+	for (guint i = 0; i < sz; i++) {
+		const gchar *device_id = NULL;
+		g_autoptr(GPtrArray) array = NULL;
+		g_autoptr(GVariant) data = g_variant_get_child_value(untuple, i);
+		g_autoptr(GVariant) releases = NULL;
+
+		g_variant_get(data, "{&s@aa{sv}}", &device_id, &releases);
+		array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+		for (guint j = 0; j < g_variant_n_children(releases); j++) {
+			g_autoptr(FwupdRelease) release = fwupd_release_new();
+			g_autoptr(GVariant) release_data = g_variant_get_child_value(releases, j);
+			if (!fwupd_codec_from_variant(FWUPD_CODEC(release), release_data, error))
+				return NULL;
+			g_ptr_array_add(array, g_steal_pointer(&release));
+		}
+		g_hash_table_insert(hash, g_strdup(device_id), g_steal_pointer(&array));
+	}
+	return g_steal_pointer(&hash);
+}
+
+static void
+fwupd_client_get_upgrades_all_cb(GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK(user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) hash = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	val = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error(error);
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+	hash = fwupd_client_upgrades_hash_from_variant(val, &error);
+	if (hash == NULL) {
+		g_task_return_error(task, g_steal_pointer(&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_pointer(task, g_steal_pointer(&hash), (GDestroyNotify)g_hash_table_unref);
+}
+
+/**
+ * fwupd_client_get_upgrades_all_async:
+ * @self: a #FwupdClient
+ * @cancellable: (nullable): optional #GCancellable
+ * @callback: (scope async) (closure callback_data): the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the upgrades for all the devices in one request, which is faster than calling
+ * [method@FwupdClient.get_upgrades_async] for each device.
+ *
+ * You must have called [method@Client.connect_async] on @self before using
+ * this method.
+ *
+ * Since: 2.1.2
+ **/
+void
+fwupd_client_get_upgrades_all_async(FwupdClient *self,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE(self);
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail(FWUPD_IS_CLIENT(self));
+	g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+	g_return_if_fail(priv->proxy != NULL);
+
+	/* call into daemon */
+	task = g_task_new(self, cancellable, callback, callback_data);
+	g_dbus_proxy_call(priv->proxy,
+			  "GetUpgradesAll",
+			  NULL,
+			  G_DBUS_CALL_FLAGS_NONE,
+			  FWUPD_CLIENT_DBUS_PROXY_TIMEOUT,
+			  cancellable,
+			  fwupd_client_get_upgrades_all_cb,
+			  g_steal_pointer(&task));
+}
+
+/**
+ * fwupd_client_get_upgrades_all_finish:
+ * @self: a #FwupdClient
+ * @res: (not nullable): the asynchronous result
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the result of [method@FwupdClient.get_upgrades_all_async].
+ *
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device IDs to an array of
+ * #FwupdRelease, where devices without any upgrades are not included
+ *
+ * Since: 2.1.2
+ **/
+GHashTable *
+fwupd_client_get_upgrades_all_finish(FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail(FWUPD_IS_CLIENT(self), NULL);
+	g_return_val_if_fail(g_task_is_valid(res, self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer(G_TASK(res), error);
+}
+
 static void
 fwupd_client_modify_config_cb(GObject *source, GAsyncResult *res, gpointer user_data)
 {
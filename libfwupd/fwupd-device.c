@@ -90,6 +90,7 @@ enum {
 	PROP_BATTERY_THRESHOLD,
 	PROP_PROBLEMS,
 	PROP_VENDOR,
+	PROP_GUIDS,
 	PROP_LAST
 };
 
@@ -817,6 +818,7 @@ fwupd_device_add_guid(FwupdDevice *self, const gchar *guid)
 		return;
 	fwupd_device_ensure_guids(self);
 	g_ptr_array_add(priv->guids, g_strdup(guid));
+	g_object_notify(G_OBJECT(self), "guids");
 }
 
 /**
@@ -3832,6 +3834,9 @@ fwupd_device_get_property(GObject *object, guint prop_id, GValue *value, GParamS
 	case PROP_BATTERY_THRESHOLD:
 		g_value_set_uint(value, priv->battery_threshold);
 		break;
+	case PROP_GUIDS:
+		g_value_set_boxed(value, fwupd_device_get_guids(self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 		break;
@@ -4111,6 +4116,20 @@ fwupd_device_class_init(FwupdDeviceClass *klass)
 				  FWUPD_BATTERY_LEVEL_INVALID,
 				  G_PARAM_READWRITE | G_PARAM_STATIC_NAME);
 	g_object_class_install_property(object_class, PROP_BATTERY_THRESHOLD, pspec);
+
+	/**
+	 * FwupdDevice:guids:
+	 *
+	 * The device GUIDs, which is notified when a GUID is added.
+	 *
+	 * Since: 2.1.2
+	 */
+	pspec = g_param_spec_boxed("guids",
+				   NULL,
+				   NULL,
+				   G_TYPE_PTR_ARRAY,
+				   G_PARAM_READABLE | G_PARAM_STATIC_NAME);
+	g_object_class_install_property(object_class, PROP_GUIDS, pspec);
 }
 
 static void
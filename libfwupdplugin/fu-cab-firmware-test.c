@@ -84,6 +84,145 @@ fu_cab_firmware_compressed_size_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_cab_firmware_compressed_stream_func(void)
+{
+	gboolean ret;
+	const gsize bufsz = (70 * 0x8000) + 0x123;
+	g_autoptr(FuCabFirmware) cab2 = fu_cab_firmware_new();
+	g_autoptr(FuCabFirmware) cab = fu_cab_firmware_new();
+	g_autoptr(FuCabImage) img = fu_cab_image_new();
+	g_autoptr(FuFirmware) img2 = NULL;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_img = NULL;
+	g_autoptr(GBytes) blob_tmp = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* use enough CFDATA blocks to need more than one dictionary checkpoint */
+	for (gsize i = 0; i < bufsz; i++)
+		fu_byte_array_append_uint8(buf, (guint8)((i * 7) ^ (i >> 9)));
+	blob_img = g_bytes_new(buf->data, buf->len);
+	fu_cab_firmware_set_compressed(cab, TRUE);
+	fu_firmware_set_bytes(FU_FIRMWARE(img), blob_img);
+	fu_firmware_set_id(FU_FIRMWARE(img), "foo.bin");
+	ret = fu_firmware_add_image(FU_FIRMWARE(cab), FU_FIRMWARE(img), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = fu_firmware_write(FU_FIRMWARE(cab), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+
+	/* parse without decompressing everything into memory */
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab2),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img2 = fu_firmware_get_image_by_id(FU_FIRMWARE(cab2), "foo.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img2);
+	stream = fu_firmware_get_stream(img2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+
+	/* seek into a block after the checkpoint, then backwards across it */
+	blob_tmp = fu_input_stream_read_bytes(stream, (65 * 0x8000) + 0x10, 0x20, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_tmp);
+	g_assert_cmpmem(g_bytes_get_data(blob_tmp, NULL),
+			g_bytes_get_size(blob_tmp),
+			buf->data + (65 * 0x8000) + 0x10,
+			0x20);
+	g_clear_pointer(&blob_tmp, g_bytes_unref);
+	blob_tmp = fu_input_stream_read_bytes(stream, (63 * 0x8000) + 0x7FF0, 0x20, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_tmp);
+	g_assert_cmpmem(g_bytes_get_data(blob_tmp, NULL),
+			g_bytes_get_size(blob_tmp),
+			buf->data + (63 * 0x8000) + 0x7FF0,
+			0x20);
+	g_clear_pointer(&blob_tmp, g_bytes_unref);
+
+	/* whole image */
+	blob_tmp = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_tmp);
+	g_assert_cmpmem(g_bytes_get_data(blob_tmp, NULL),
+			g_bytes_get_size(blob_tmp),
+			buf->data,
+			buf->len);
+}
+
+static void
+fu_cab_firmware_compressed_dictionary_func(void)
+{
+	gboolean ret;
+	const gsize offsets[] = {0x7FF0, 0x27FF0, 0x10000, 0x0, 0x1FFFF, 0x8000};
+	guint8 pattern[0x1000] = {0x0};
+	g_autoptr(FuCabFirmware) cab2 = fu_cab_firmware_new();
+	g_autoptr(FuCabFirmware) cab = fu_cab_firmware_new();
+	g_autoptr(FuCabImage) img = fu_cab_image_new();
+	g_autoptr(FuFirmware) img2 = NULL;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_img = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* the random data only compresses using back-references into the previous block */
+	for (guint i = 0; i < sizeof(pattern); i++)
+		pattern[i] = (guint8)g_test_rand_int();
+	for (guint i = 0; i < 0x28; i++)
+		g_byte_array_append(buf, pattern, sizeof(pattern));
+	blob_img = g_bytes_new(buf->data, buf->len);
+	fu_cab_firmware_set_compressed(cab, TRUE);
+	fu_firmware_set_bytes(FU_FIRMWARE(img), blob_img);
+	fu_firmware_set_id(FU_FIRMWARE(img), "foo.bin");
+	ret = fu_firmware_add_image(FU_FIRMWARE(cab), FU_FIRMWARE(img), &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	blob = fu_firmware_write(FU_FIRMWARE(cab), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	g_assert_cmpint(g_bytes_get_size(blob), <, 2 * sizeof(pattern));
+
+	/* parse */
+	ret = fu_firmware_parse_bytes(FU_FIRMWARE(cab2),
+				      blob,
+				      0x0,
+				      FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM,
+				      &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img2 = fu_firmware_get_image_by_id(FU_FIRMWARE(cab2), "foo.bin", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img2);
+	stream = fu_firmware_get_stream(img2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+
+	/* read across the block boundaries in both directions */
+	for (guint i = 0; i < G_N_ELEMENTS(offsets); i++) {
+		g_autoptr(GBytes) blob_tmp = NULL;
+		blob_tmp = fu_input_stream_read_bytes(stream, offsets[i], 0x10, NULL, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(blob_tmp);
+		g_assert_cmpmem(g_bytes_get_data(blob_tmp, NULL),
+				g_bytes_get_size(blob_tmp),
+				buf->data + offsets[i],
+				0x10);
+	}
+
+	/* outside of the stream */
+	ret = g_seekable_seek(G_SEEKABLE(stream), buf->len + 1, G_SEEK_SET, NULL, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -91,5 +230,9 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/cab-firmware/checksum", fu_cab_firmware_checksum_func);
 	g_test_add_func("/fwupd/cab-firmware/compressed-size",
 			fu_cab_firmware_compressed_size_func);
+	g_test_add_func("/fwupd/cab-firmware/compressed-stream",
+			fu_cab_firmware_compressed_stream_func);
+	g_test_add_func("/fwupd/cab-firmware/compressed-dictionary",
+			fu_cab_firmware_compressed_dictionary_func);
 	return g_test_run();
 }
@@ -18,7 +18,7 @@
 #include "fu-common.h"
 #include "fu-composite-input-stream.h"
 #include "fu-input-stream.h"
-#include "fu-mem-private.h"
+#include "fu-mszip-input-stream.h"
 #include "fu-partial-input-stream.h"
 #include "fu-path.h"
 #include "fu-string.h"
@@ -34,8 +34,6 @@ G_DEFINE_TYPE_WITH_PRIVATE(FuCabFirmware, fu_cab_firmware, FU_TYPE_FIRMWARE)
 #define FU_CAB_FIRMWARE_MAX_FOLDERS  64
 #define FU_CAB_FIRMWARE_MAX_FILENAME 1000
 
-#define FU_CAB_FIRMWARE_DECOMPRESS_BUFSZ 0x4000 /* bytes */
-
 /**
  * fu_cab_firmware_get_compressed:
  * @self: a #FuCabFirmware
@@ -78,22 +76,17 @@ typedef struct {
 	gsize rsvd_block;
 	gsize size_total;
 	FuCabCompression compression;
-	GPtrArray *folder_data; /* of FuCompositeInputStream */
-	z_stream zstrm;
-	guint8 *decompress_buf;
-	gsize decompress_bufsz;
+	GPtrArray *folder_data; /* of FuMszipInputStream or FuCompositeInputStream */
 	gsize ndatabsz;
 } FuCabFirmwareParseHelper;
 
 static void
 fu_cab_firmware_parse_helper_free(FuCabFirmwareParseHelper *helper)
 {
-	inflateEnd(&helper->zstrm);
 	if (helper->stream != NULL)
 		g_object_unref(helper->stream);
 	if (helper->folder_data != NULL)
 		g_ptr_array_unref(helper->folder_data);
-	g_free(helper->decompress_buf);
 	g_free(helper);
 }
 
@@ -174,11 +167,12 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 	gsize hdr_sz;
 	gsize payload_offset = *offset;
 	gsize size_max = fu_firmware_get_size_max(FU_FIRMWARE(self));
-	g_autoptr(FuStructCabData) st = NULL;
+	const FuStructCabData *st;
+	FuStructCabDataView st_view;
 	g_autoptr(GInputStream) partial_stream = NULL;
 
-	/* parse header */
-	st = fu_struct_cab_data_parse_stream(helper->stream, *offset, error);
+	/* parse header, without allocating as there may be thousands of these */
+	st = fu_struct_cab_data_view_stream(&st_view, helper->stream, *offset, error);
 	if (st == NULL)
 		return FALSE;
 
@@ -265,135 +259,11 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 
 	/* decompress Zlib data after removing *another *header... */
 	if (helper->compression == FU_CAB_COMPRESSION_MSZIP) {
-		int zret;
-		g_autofree gchar *kind = NULL;
-		g_autoptr(GByteArray) buf = g_byte_array_new();
-		g_autoptr(GBytes) bytes_comp = NULL;
-		g_autoptr(GBytes) bytes_uncomp = NULL;
-
-		/* check compressed header */
-		bytes_comp = fu_input_stream_read_bytes(helper->stream,
-							payload_offset,
-							blob_comp,
-							NULL,
-							error);
-		if (bytes_comp == NULL)
-			return FALSE;
-		kind = fu_memstrsafe(g_bytes_get_data(bytes_comp, NULL),
-				     g_bytes_get_size(bytes_comp),
-				     0x0,
-				     2,
-				     error);
-		if (kind == NULL)
-			return FALSE;
-		if (g_strcmp0(kind, "CK") != 0) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "compressed header invalid: %s",
-				    kind);
-			return FALSE;
-		}
-		if (helper->decompress_buf == NULL) {
-			/* sanity check decompress buffer size */
-			if (helper->decompress_bufsz == 0 ||
-			    helper->decompress_bufsz > 32 * FU_MB) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_INVALID_DATA,
-					    "invalid decompress buffer size: 0x%x",
-					    (guint)helper->decompress_bufsz);
-				return FALSE;
-			}
-			helper->decompress_buf = g_malloc0(helper->decompress_bufsz);
-		}
-		helper->zstrm.avail_in = g_bytes_get_size(bytes_comp) - 2;
-		helper->zstrm.next_in = (z_const Bytef *)g_bytes_get_data(bytes_comp, NULL) + 2;
-		while (1) {
-			helper->zstrm.avail_out = helper->decompress_bufsz;
-			helper->zstrm.next_out = helper->decompress_buf;
-			zret = inflate(&helper->zstrm, Z_BLOCK);
-			g_byte_array_append(buf,
-					    helper->decompress_buf,
-					    helper->decompress_bufsz - helper->zstrm.avail_out);
-			if (buf->len > blob_uncomp) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_INVALID_DATA,
-					    "decompressed size mismatch (0x%x, specified 0x%x)",
-					    (guint)buf->len,
-					    (guint)blob_uncomp);
-				return FALSE;
-			}
-			if (zret == Z_STREAM_END)
-				break;
-			if (zret != Z_OK) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_NOT_SUPPORTED,
-					    "inflate error @0x%x: %s",
-					    (guint)*offset,
-					    zError(zret));
-				return FALSE;
-			}
-
-			/* prevent decompression bombs */
-			if (size_max > 0 && buf->len > size_max) {
-				g_set_error(error,
-					    FWUPD_ERROR,
-					    FWUPD_ERROR_INVALID_DATA,
-					    "decompressed data too large (0x%x, limit 0x%x)",
-					    (guint)buf->len,
-					    (guint)size_max);
-				return FALSE;
-			}
-		}
-
-		/* verify actual decompressed size matches declared size */
-		if (buf->len != blob_uncomp) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "decompressed size mismatch (0x%x, specified 0x%x)",
-				    (guint)buf->len,
-				    (guint)blob_uncomp);
-			return FALSE;
-		}
-
-		zret = inflateReset(&helper->zstrm);
-		if (zret != Z_OK) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "failed to reset inflate: %s",
-				    zError(zret));
-			return FALSE;
-		}
-
-		/* sanity check to zlib dictionary maximum */
-		if (buf->len > 32 * FU_KB) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_INVALID_DATA,
-				    "dictionary size 0x%x exceeds zlib maximum",
-				    (guint)buf->len);
-			return FALSE;
-		}
-
-		zret = inflateSetDictionary(&helper->zstrm, buf->data, buf->len);
-		if (zret != Z_OK) {
-			g_set_error(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_SUPPORTED,
-				    "failed to set inflate dictionary: %s",
-				    zError(zret));
-			return FALSE;
-		}
-		bytes_uncomp =
-		    g_byte_array_free_to_bytes(g_steal_pointer(&buf)); /* nocheck:blocked */
-		if (!fu_composite_input_stream_add_bytes(FU_COMPOSITE_INPUT_STREAM(folder_data),
-							 bytes_uncomp,
-							 error))
+		if (!fu_mszip_input_stream_add_block(FU_MSZIP_INPUT_STREAM(folder_data),
+						     payload_offset,
+						     blob_comp,
+						     blob_uncomp,
+						     error))
 			return FALSE;
 	} else {
 		if (!fu_composite_input_stream_add_partial_stream(
@@ -409,21 +279,21 @@ fu_cab_firmware_parse_data(FuCabFirmware *self,
 	return fu_size_checked_inc(offset, hdr_sz, error);
 }
 
-static gboolean
+static GInputStream *
 fu_cab_firmware_parse_folder(FuCabFirmware *self,
 			     FuCabFirmwareParseHelper *helper,
 			     guint idx,
 			     gsize offset,
-			     GInputStream *folder_data,
 			     GError **error)
 {
 	FuCabFirmwarePrivate *priv = GET_PRIVATE(self);
 	g_autoptr(FuStructCabFolder) st = NULL;
+	g_autoptr(GInputStream) folder_data = NULL;
 
 	/* parse header */
 	st = fu_struct_cab_folder_parse_stream(helper->stream, offset, error);
 	if (st == NULL)
-		return FALSE;
+		return NULL;
 
 	/* sanity check */
 	if (fu_struct_cab_folder_get_ndatab(st) == 0) {
@@ -431,7 +301,7 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_SUPPORTED,
 				    "no CFDATA blocks");
-		return FALSE;
+		return NULL;
 	}
 	helper->compression = fu_struct_cab_folder_get_compression(st);
 	if (helper->compression != FU_CAB_COMPRESSION_NONE)
@@ -443,25 +313,34 @@ fu_cab_firmware_parse_folder(FuCabFirmware *self,
 			    FWUPD_ERROR_NOT_SUPPORTED,
 			    "compression %s not supported",
 			    fu_cab_compression_to_string(helper->compression));
-		return FALSE;
+		return NULL;
+	}
+
+	/* MSZIP blocks are only decompressed when read, apart from being verified when added */
+	if (helper->compression == FU_CAB_COMPRESSION_MSZIP) {
+		folder_data = fu_mszip_input_stream_new(helper->stream, error);
+		if (folder_data == NULL)
+			return NULL;
+	} else {
+		folder_data = fu_composite_input_stream_new();
 	}
 
 	/* parse CDATA, either using the stream offset or the per-spec FuStructCabFolder.ndatab */
 	if (helper->ndatabsz > 0) {
 		for (gsize off = fu_struct_cab_folder_get_offset(st); off < helper->ndatabsz;) {
 			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
-				return FALSE;
+				return NULL;
 		}
 	} else {
 		gsize off = fu_struct_cab_folder_get_offset(st);
 		for (guint16 i = 0; i < fu_struct_cab_folder_get_ndatab(st); i++) {
 			if (!fu_cab_firmware_parse_data(self, helper, &off, folder_data, error))
-				return FALSE;
+				return NULL;
 		}
 	}
 
 	/* success */
-	return TRUE;
+	return g_steal_pointer(&folder_data);
 }
 
 static gboolean
@@ -580,26 +459,11 @@ fu_cab_firmware_validate(FuFirmware *firmware, GInputStream *stream, gsize offse
 static FuCabFirmwareParseHelper *
 fu_cab_firmware_parse_helper_new(GInputStream *stream, FuFirmwareParseFlags flags, GError **error)
 {
-	int zret;
 	g_autoptr(FuCabFirmwareParseHelper) helper = g_new0(FuCabFirmwareParseHelper, 1);
 
-	/* zlib */
-	helper->zstrm.zalloc = fu_cab_firmware_zalloc;
-	helper->zstrm.zfree = fu_cab_firmware_zfree;
-	zret = inflateInit2(&helper->zstrm, -MAX_WBITS);
-	if (zret != Z_OK) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "failed to initialize inflate: %s",
-			    zError(zret));
-		return NULL;
-	}
-
 	helper->stream = g_object_ref(stream);
 	helper->parse_flags = flags;
 	helper->folder_data = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	helper->decompress_bufsz = FU_CAB_FIRMWARE_DECOMPRESS_BUFSZ;
 	return g_steal_pointer(&helper);
 }
 
@@ -730,8 +594,9 @@ fu_cab_firmware_parse(FuFirmware *firmware,
 
 	/* parse CFFOLDER */
 	for (guint i = 0; i < fu_struct_cab_header_get_nr_folders(st); i++) {
-		g_autoptr(GInputStream) folder_data = fu_composite_input_stream_new();
-		if (!fu_cab_firmware_parse_folder(self, helper, i, offset, folder_data, error))
+		g_autoptr(GInputStream) folder_data = NULL;
+		folder_data = fu_cab_firmware_parse_folder(self, helper, i, offset, error);
+		if (folder_data == NULL)
 			return FALSE;
 		if (!fu_input_stream_size(folder_data, &streamsz, error))
 			return FALSE;
@@ -828,6 +693,7 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 	}
 	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
 		g_autoptr(FuChunk) chk = NULL;
+		g_autoptr(FuChunk) chk_prev = NULL;
 		g_autoptr(GByteArray) chunk_zlib = g_byte_array_new();
 		g_autoptr(GByteArray) buf = g_byte_array_new();
 
@@ -861,6 +727,24 @@ fu_cab_firmware_write(FuFirmware *firmware, GError **error)
 					    zError(zret));
 				return NULL;
 			}
+
+			/* each block uses the previous block as the dictionary, like makecab */
+			if (i > 0) {
+				chk_prev = fu_chunk_array_index(chunks, i - 1, error);
+				if (chk_prev == NULL)
+					return NULL;
+				zret = deflateSetDictionary(zstrm_deflater,
+							    fu_chunk_get_data(chk_prev),
+							    fu_chunk_get_data_sz(chk_prev));
+				if (zret != Z_OK) {
+					g_set_error(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_NOT_SUPPORTED,
+						    "failed to set deflate dictionary: %s",
+						    zError(zret));
+					return NULL;
+				}
+			}
 			zret = deflate(zstrm_deflater, Z_FINISH);
 			if (zret != Z_OK && zret != Z_STREAM_END) {
 				g_set_error(error,
@@ -1,7 +1,7 @@
 // Copyright 2023 Richard Hughes <richard@hughsie.com>
 // SPDX-License-Identifier: LGPL-2.1-or-later
 
-#[derive(ParseStream, New)]
+#[derive(ViewStream, New)]
 #[repr(C, packed)]
 struct FuStructCabData {
     checksum: u32le,
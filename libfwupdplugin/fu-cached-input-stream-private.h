@@ -0,0 +1,13 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-cached-input-stream.h"
+
+const guint8 *
+fu_cached_input_stream_peek(FuCachedInputStream *self, gsize offset, gsize count, GError **error)
+    G_GNUC_NON_NULL(1);
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+#include "fu-cached-input-stream-private.h"
+
+static void
+fu_cached_input_stream_func(void)
+{
+	gboolean ret;
+	gssize rc;
+	guint8 buf[6] = {0x0};
+	guint32 value = 0;
+	const guint8 *data;
+	g_autoptr(FuChunkArray) chunks = NULL;
+	g_autoptr(GBytes) blob = g_bytes_new_static("0123456789abcdef", 16);
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) base_stream = g_memory_input_stream_new_from_bytes(blob);
+	g_autoptr(GInputStream) stream = NULL;
+	g_autofree gchar *str = NULL;
+
+	/* tiny pages so that reads span them */
+	stream = fu_cached_input_stream_new(base_stream, 4, 2, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	ret = g_seekable_seek(G_SEEKABLE(stream), 0x2, G_SEEK_SET, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	rc = g_input_stream_read(stream, buf, sizeof(buf), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(rc, ==, 6);
+	g_assert_cmpmem(buf, 6, "234567", 6);
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(stream)), ==, 0x8);
+
+	/* read again from memory */
+	ret = fu_input_stream_read_u32(stream, 0x4, &value, G_BIG_ENDIAN, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(value, ==, 0x34353637);
+
+	/* evict the first page and read it again */
+	ret = fu_input_stream_read_u32(stream, 0xC, &value, G_BIG_ENDIAN, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(value, ==, 0x63646566);
+	ret = fu_input_stream_read_u32(stream, 0x0, &value, G_BIG_ENDIAN, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(value, ==, 0x30313233);
+
+	/* read at the end */
+	ret = g_seekable_seek(G_SEEKABLE(stream), -1, G_SEEK_END, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	rc = g_input_stream_read(stream, buf, sizeof(buf), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(rc, ==, 1);
+	g_assert_cmpint(buf[0], ==, 'f');
+	rc = g_input_stream_read(stream, buf, sizeof(buf), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(rc, ==, 0);
+
+	/* seek past the end */
+	ret = g_seekable_seek(G_SEEKABLE(stream), 0x11, G_SEEK_SET, NULL, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* slice a page without copying */
+	data = fu_cached_input_stream_peek(FU_CACHED_INPUT_STREAM(stream), 0x9, 3, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(data);
+	g_assert_cmpmem(data, 3, "9ab", 3);
+	data = fu_cached_input_stream_peek(FU_CACHED_INPUT_STREAM(stream), 0x6, 4, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(data);
+	g_clear_error(&error);
+
+	/* peeked chunks either slice a page or are copied if they span pages */
+	chunks = fu_chunk_array_new_from_stream(stream,
+						FU_CHUNK_ADDR_OFFSET_NONE,
+						FU_CHUNK_PAGESZ_NONE,
+						3,
+						&error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+		FuChunk *chk = fu_chunk_array_index_peek(chunks, i, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(chk);
+		g_assert_cmpmem(fu_chunk_get_data(chk),
+				fu_chunk_get_data_sz(chk),
+				(const guint8 *)g_bytes_get_data(blob, NULL) + (i * 3),
+				fu_chunk_get_data_sz(chk));
+	}
+
+	/* convert back to bytes */
+	blob2 = fu_input_stream_read_bytes(stream, 0x0, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob2);
+	g_assert_cmpint(g_bytes_compare(blob, blob2), ==, 0);
+
+	str = fwupd_codec_to_string(FWUPD_CODEC(stream));
+	g_debug("%s", str);
+}
+
+static void
+fu_cached_input_stream_chunk_array_func(void)
+{
+	gboolean ret;
+	gsize bufsz = 0x40000;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) composite_stream = fu_composite_input_stream_new();
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(FuChunkArray) chunks = NULL;
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)(i * 7);
+	blob = g_bytes_new_static(buf, bufsz);
+	ret = fu_composite_input_stream_add_bytes(FU_COMPOSITE_INPUT_STREAM(composite_stream),
+						  blob,
+						  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	stream = fu_partial_input_stream_new(composite_stream, 0x10, bufsz - 0x20, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+
+	/* the stream gets cached, but the data is the same */
+	chunks = fu_chunk_array_new_from_stream(stream, 0x0, FU_CHUNK_PAGESZ_NONE, 60, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+	for (guint i = 0; i < fu_chunk_array_length(chunks); i++) {
+		g_autoptr(FuChunk) chk = fu_chunk_array_index(chunks, i, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(chk);
+		g_assert_cmpmem(fu_chunk_get_data(chk),
+				fu_chunk_get_data_sz(chk),
+				buf + 0x10 + fu_chunk_get_address(chk),
+				fu_chunk_get_data_sz(chk));
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/cached-input-stream", fu_cached_input_stream_func);
+	g_test_add_func("/fwupd/cached-input-stream/chunk-array",
+			fu_cached_input_stream_chunk_array_func);
+	return g_test_run();
+}
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuCachedInputStream"
+
+#include "config.h"
+
+#include <string.h>
+
+#include "fwupd-codec.h"
+
+#include "fu-cached-input-stream-private.h"
+#include "fu-common.h"
+#include "fu-input-stream.h"
+
+/**
+ * FuCachedInputStream:
+ *
+ * A input stream that caches pages of another seekable input stream.
+ *
+ * This is useful when the base stream is expensive to seek and read, for instance a partial
+ * stream of a composite stream of a decompressed archive, and the caller does many small reads.
+ *
+ * The least recently used page is reused when the cache is full. The base stream must not change
+ * while this stream is being used.
+ */
+
+typedef struct {
+	gsize offset; /* in base stream */
+	gsize size;   /* valid data in buf */
+	guint8 *buf;  /* of size page_size */
+} FuCachedInputStreamPage;
+
+struct _FuCachedInputStream {
+	GInputStream parent_instance;
+	GInputStream *base_stream;
+	gsize page_size;
+	guint pages_max;
+	GQueue pages; /* of FuCachedInputStreamPage, most recently used first */
+	goffset pos;
+	gsize total_size;
+	guint hits;
+	guint misses;
+};
+
+static void
+fu_cached_input_stream_seekable_iface_init(GSeekableIface *iface);
+static void
+fu_cached_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuCachedInputStream,
+			fu_cached_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_cached_input_stream_seekable_iface_init)
+			    G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+						  fu_cached_input_stream_codec_iface_init))
+
+static void
+fu_cached_input_stream_page_free(FuCachedInputStreamPage *page)
+{
+	g_free(page->buf);
+	g_free(page);
+}
+
+static void
+fu_cached_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuCachedInputStream *self = FU_CACHED_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "PageSize", self->page_size);
+	fwupd_codec_string_append_int(str, idt, "PagesMax", self->pages_max);
+	fwupd_codec_string_append_int(str, idt, "Hits", self->hits);
+	fwupd_codec_string_append_int(str, idt, "Misses", self->misses);
+}
+
+static void
+fu_cached_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_cached_input_stream_add_string;
+}
+
+static goffset
+fu_cached_input_stream_tell(GSeekable *seekable)
+{
+	FuCachedInputStream *self = FU_CACHED_INPUT_STREAM(seekable);
+	g_return_val_if_fail(FU_IS_CACHED_INPUT_STREAM(self), -1);
+	return self->pos;
+}
+
+static gboolean
+fu_cached_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_cached_input_stream_seek(GSeekable *seekable,
+			    goffset offset,
+			    GSeekType type,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuCachedInputStream *self = FU_CACHED_INPUT_STREAM(seekable);
+	goffset pos;
+
+	g_return_val_if_fail(FU_IS_CACHED_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (type == G_SEEK_CUR) {
+		pos = self->pos + offset;
+	} else if (type == G_SEEK_END) {
+		pos = self->total_size + offset;
+	} else {
+		pos = offset;
+	}
+	if (pos < 0 || (gsize)pos > self->total_size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "requested position 0x%x outside of 0x%x",
+			    (guint)pos,
+			    (guint)self->total_size);
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_cached_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_cached_input_stream_truncate(GSeekable *seekable,
+				goffset offset,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuCachedInputStream");
+	return FALSE;
+}
+
+static void
+fu_cached_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_cached_input_stream_tell;
+	iface->can_seek = fu_cached_input_stream_can_seek;
+	iface->seek = fu_cached_input_stream_seek;
+	iface->can_truncate = fu_cached_input_stream_can_truncate;
+	iface->truncate_fn = fu_cached_input_stream_truncate;
+}
+
+static FuCachedInputStreamPage *
+fu_cached_input_stream_ensure_page(FuCachedInputStream *self, gsize offset, GError **error)
+{
+	FuCachedInputStreamPage *page = NULL;
+
+	/* already cached, so make most recently used */
+	for (GList *l = self->pages.head; l != NULL; l = l->next) {
+		page = l->data;
+		if (page->offset == offset) {
+			self->hits++;
+			if (l != self->pages.head) {
+				g_queue_unlink(&self->pages, l);
+				g_queue_push_head_link(&self->pages, l);
+			}
+			return page;
+		}
+	}
+
+	/* reuse the least recently used page if full */
+	self->misses++;
+	if (self->pages.length >= self->pages_max) {
+		page = g_queue_pop_tail(&self->pages);
+	} else {
+		page = g_new0(FuCachedInputStreamPage, 1);
+		page->buf = g_malloc0(MIN(self->page_size, self->total_size));
+	}
+	page->offset = offset;
+	page->size = MIN(self->page_size, self->total_size - offset);
+	if (!fu_input_stream_read_safe(self->base_stream,
+				       page->buf,
+				       page->size,
+				       0x0,
+				       offset,
+				       page->size,
+				       error)) {
+		fu_cached_input_stream_page_free(page);
+		return NULL;
+	}
+	g_queue_push_head(&self->pages, page);
+	return page;
+}
+
+static gssize
+fu_cached_input_stream_read(GInputStream *stream,
+			    void *buffer,
+			    gsize count,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuCachedInputStream *self = FU_CACHED_INPUT_STREAM(stream);
+	gsize done = 0;
+
+	g_return_val_if_fail(FU_IS_CACHED_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	/* may span multiple pages */
+	while (done < count && (gsize)self->pos < self->total_size) {
+		FuCachedInputStreamPage *page;
+		gsize page_offset = (self->pos / self->page_size) * self->page_size;
+		gsize chunksz;
+
+		page = fu_cached_input_stream_ensure_page(self, page_offset, error);
+		if (page == NULL)
+			return -1;
+		chunksz = MIN(count - done, page->size - (self->pos - page_offset));
+		memcpy((guint8 *)buffer + done, /* nocheck:blocked */
+		       page->buf + (self->pos - page_offset),
+		       chunksz);
+		done += chunksz;
+		self->pos += chunksz;
+	}
+	return done;
+}
+
+/* private: the returned data is only valid until the next read, as the page may be reused */
+const guint8 *
+fu_cached_input_stream_peek(FuCachedInputStream *self, gsize offset, gsize count, GError **error)
+{
+	FuCachedInputStreamPage *page;
+	gsize page_offset = (offset / self->page_size) * self->page_size;
+
+	g_return_val_if_fail(FU_IS_CACHED_INPUT_STREAM(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (count > self->total_size || offset > self->total_size - count) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "requested 0x%x at 0x%x outside of 0x%x",
+			    (guint)count,
+			    (guint)offset,
+			    (guint)self->total_size);
+		return NULL;
+	}
+	if (offset + count > page_offset + self->page_size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "requested 0x%x at 0x%x spans pages of 0x%x",
+			    (guint)count,
+			    (guint)offset,
+			    (guint)self->page_size);
+		return NULL;
+	}
+	page = fu_cached_input_stream_ensure_page(self, page_offset, error);
+	if (page == NULL)
+		return NULL;
+	return page->buf + (offset - page_offset);
+}
+
+/**
+ * fu_cached_input_stream_new:
+ * @stream: a seekable base #GInputStream
+ * @page_size: size of each page in bytes, typically %FU_CACHED_INPUT_STREAM_PAGE_SIZE_DEFAULT
+ * @pages_max: maximum number of pages, typically %FU_CACHED_INPUT_STREAM_PAGES_MAX_DEFAULT
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream where content is read from the base stream in large pages, and then
+ * subsequent reads are satisfied from memory.
+ *
+ * Returns: (transfer full): a #FuCachedInputStream, or %NULL on error
+ *
+ * Since: 2.1.2
+ **/
+GInputStream *
+fu_cached_input_stream_new(GInputStream *stream, gsize page_size, guint pages_max, GError **error)
+{
+	g_autoptr(FuCachedInputStream) self = g_object_new(FU_TYPE_CACHED_INPUT_STREAM, NULL);
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(page_size > 0, NULL);
+	g_return_val_if_fail(pages_max > 0, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (!fu_input_stream_size(stream, &self->total_size, error)) {
+		g_prefix_error_literal(error, "failed to get size: ");
+		return NULL;
+	}
+	self->base_stream = g_object_ref(stream);
+	self->page_size = page_size;
+	self->pages_max = pages_max;
+
+	/* success */
+	return G_INPUT_STREAM(g_steal_pointer(&self));
+}
+
+static void
+fu_cached_input_stream_finalize(GObject *object)
+{
+	FuCachedInputStream *self = FU_CACHED_INPUT_STREAM(object);
+	g_queue_clear_full(&self->pages, (GDestroyNotify)fu_cached_input_stream_page_free);
+	if (self->base_stream != NULL)
+		g_object_unref(self->base_stream);
+	G_OBJECT_CLASS(fu_cached_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_cached_input_stream_class_init(FuCachedInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_cached_input_stream_read;
+	object_class->finalize = fu_cached_input_stream_finalize;
+}
+
+static void
+fu_cached_input_stream_init(FuCachedInputStream *self)
+{
+	g_queue_init(&self->pages);
+}
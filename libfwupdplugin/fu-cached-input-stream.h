@@ -0,0 +1,39 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#define FU_TYPE_CACHED_INPUT_STREAM (fu_cached_input_stream_get_type())
+
+G_DECLARE_FINAL_TYPE(FuCachedInputStream,
+		     fu_cached_input_stream,
+		     FU,
+		     CACHED_INPUT_STREAM,
+		     GInputStream)
+
+/**
+ * FU_CACHED_INPUT_STREAM_PAGE_SIZE_DEFAULT:
+ *
+ * The default size of each cached page.
+ *
+ * Since: 2.1.2
+ **/
+#define FU_CACHED_INPUT_STREAM_PAGE_SIZE_DEFAULT 0x10000
+
+/**
+ * FU_CACHED_INPUT_STREAM_PAGES_MAX_DEFAULT:
+ *
+ * The default number of pages to cache.
+ *
+ * Since: 2.1.2
+ **/
+#define FU_CACHED_INPUT_STREAM_PAGES_MAX_DEFAULT 4
+
+GInputStream *
+fu_cached_input_stream_new(GInputStream *stream, gsize page_size, guint pages_max, GError **error)
+    G_GNUC_NON_NULL(1);
@@ -55,6 +55,147 @@ fu_chunk_array_func(void)
 	g_assert_null(chk4);
 }
 
+static void
+fu_chunk_array_peek_func(void)
+{
+	gsize bufsz = 256 * 1024;
+	guint n_chunks;
+	guint8 checksum_index = 0;
+	guint8 checksum_peek = 0;
+	FuChunk *chk_first = NULL;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(FuChunkArray) chunks = NULL;
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)(i * 7);
+	blob = g_bytes_new_static(buf, bufsz);
+	stream = g_memory_input_stream_new_from_bytes(blob);
+	chunks = fu_chunk_array_new_from_stream(stream, 0x8000000, 0x1000, 64, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(chunks);
+	n_chunks = fu_chunk_array_length(chunks);
+	g_assert_cmpint(n_chunks, ==, bufsz / 64);
+
+	/* one new chunk and buffer per packet */
+	for (guint i = 0; i < n_chunks; i++) {
+		g_autoptr(FuChunk) chk = fu_chunk_array_index(chunks, i, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(chk);
+		checksum_index ^= fu_chunk_get_data(chk)[fu_chunk_get_data_sz(chk) - 1];
+	}
+
+	/* one chunk and buffer for all packets */
+	for (guint i = 0; i < n_chunks; i++) {
+		FuChunk *chk = fu_chunk_array_index_peek(chunks, i, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(chk);
+		if (chk_first == NULL)
+			chk_first = chk;
+		g_assert_true(chk == chk_first);
+		g_assert_cmpint(fu_chunk_get_idx(chk), ==, i);
+		g_assert_cmpint(fu_chunk_get_data_sz(chk), ==, 64);
+		checksum_peek ^= fu_chunk_get_data(chk)[fu_chunk_get_data_sz(chk) - 1];
+	}
+	g_assert_cmpint(checksum_peek, ==, checksum_index);
+
+	/* random access still works */
+	for (guint i = 0; i < 3; i++) {
+		guint idx = (n_chunks - 1) / (i + 1);
+		g_autoptr(FuChunk) chk = fu_chunk_array_index(chunks, idx, &error);
+		FuChunk *chk_peek = fu_chunk_array_index_peek(chunks, idx, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(chk);
+		g_assert_nonnull(chk_peek);
+		g_assert_cmpint(fu_chunk_get_page(chk_peek), ==, fu_chunk_get_page(chk));
+		g_assert_cmpint(fu_chunk_get_address(chk_peek), ==, fu_chunk_get_address(chk));
+		g_assert_cmpmem(fu_chunk_get_data(chk_peek), 64, fu_chunk_get_data(chk), 64);
+	}
+	g_assert_null(fu_chunk_array_index_peek(chunks, n_chunks, NULL));
+}
+
+static void
+fu_chunk_array_alloc_finalize_cb(gpointer user_data, GObject *where_the_object_was)
+{
+	guint *cnt = (guint *)user_data;
+	(*cnt)++;
+}
+
+/* a chunk that owns a GBytes returns a new reference to it rather than a new static wrapper */
+static gboolean
+fu_chunk_array_alloc_chunk_owns_bytes(FuChunk *chk)
+{
+	g_autoptr(GBytes) blob1 = fu_chunk_get_bytes(chk);
+	g_autoptr(GBytes) blob2 = fu_chunk_get_bytes(chk);
+	return blob1 == blob2;
+}
+
+static void
+fu_chunk_array_alloc_func(void)
+{
+	for (gsize mib = 1; mib <= 4; mib *= 2) {
+		gsize bufsz = mib * 1024 * 1024;
+		guint n_chunks;
+		guint index_bytes = 0;
+		guint index_chunks = 0;
+		guint peek_bytes = 0;
+		guint peek_chunks = 0;
+		FuChunk *chk_last = NULL;
+		g_autofree guint8 *buf = g_malloc0(bufsz);
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GError) error = NULL;
+		g_autoptr(GInputStream) stream = NULL;
+		g_autoptr(FuChunkArray) chunks = NULL;
+
+		blob = g_bytes_new_static(buf, bufsz);
+		stream = g_memory_input_stream_new_from_bytes(blob);
+		chunks = fu_chunk_array_new_from_stream(stream, 0x0, 0x1000, 64, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(chunks);
+		n_chunks = fu_chunk_array_length(chunks);
+
+		/* every chunk is finalized when the last reference is dropped */
+		for (guint i = 0; i < n_chunks; i++) {
+			g_autoptr(FuChunk) chk = fu_chunk_array_index(chunks, i, &error);
+			g_assert_no_error(error);
+			g_assert_nonnull(chk);
+			g_object_weak_ref(G_OBJECT(chk),
+					  fu_chunk_array_alloc_finalize_cb,
+					  &index_chunks);
+			if (fu_chunk_array_alloc_chunk_owns_bytes(chk))
+				index_bytes++;
+		}
+		g_assert_cmpint(index_chunks, ==, n_chunks);
+		g_assert_cmpint(index_bytes, ==, n_chunks);
+
+		/* the peeked chunk is reused, so count the distinct objects */
+		for (guint i = 0; i < n_chunks; i++) {
+			FuChunk *chk = fu_chunk_array_index_peek(chunks, i, &error);
+			g_assert_no_error(error);
+			g_assert_nonnull(chk);
+			if (chk != chk_last) {
+				chk_last = chk;
+				peek_chunks++;
+			}
+			if (fu_chunk_array_alloc_chunk_owns_bytes(chk))
+				peek_bytes++;
+		}
+		g_test_message("%" G_GSIZE_FORMAT " MiB: index %u FuChunk + %u GBytes per MiB, "
+			       "peek %u FuChunk + %u GBytes per MiB",
+			       mib,
+			       index_chunks / (guint)mib,
+			       index_bytes / (guint)mib,
+			       peek_chunks / (guint)mib,
+			       peek_bytes / (guint)mib);
+
+		/* does not depend on the size of the stream */
+		g_assert_cmpint(peek_chunks, ==, 1);
+		g_assert_cmpint(peek_bytes, ==, 0);
+	}
+}
+
 static void
 fu_chunk_func(void)
 {
@@ -252,5 +393,8 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/chunk", fu_chunk_func);
 	g_test_add_func("/fwupd/chunk-array", fu_chunk_array_func);
 	g_test_add_func("/fwupd/chunk-array/null", fu_chunk_array_null_func);
+	g_test_add_func("/fwupd/chunk-array/peek", fu_chunk_array_peek_func);
+	if (g_test_perf())
+		g_test_add_func("/fwupd/chunk-array/alloc", fu_chunk_array_alloc_func);
 	return g_test_run();
 }
@@ -9,9 +9,12 @@
 #include "config.h"
 
 #include "fu-bytes.h"
+#include "fu-cached-input-stream-private.h"
 #include "fu-chunk-array.h"
 #include "fu-chunk-private.h"
 #include "fu-input-stream.h"
+#include "fu-mapped-input-stream.h"
+#include "fu-partial-input-stream-private.h"
 
 /**
  * FuChunkArray:
@@ -28,8 +31,13 @@ struct _FuChunkArray {
 	gsize packet_sz;
 	GArray *offsets; /* of gsize */
 	gsize total_size;
+	FuChunk *chk_peek;	/* nullable, reused by fu_chunk_array_index_peek() */
+	GByteArray *readahead;	/* nullable */
+	gsize readahead_offset; /* of the stream */
 };
 
+#define FU_CHUNK_ARRAY_READAHEAD_SZ 0x10000
+
 G_DEFINE_TYPE(FuChunkArray, fu_chunk_array, G_TYPE_OBJECT)
 
 /**
@@ -148,6 +156,125 @@ fu_chunk_array_index(FuChunkArray *self, guint idx, GError **error)
 	return g_steal_pointer(&chk);
 }
 
+/* ensures @chunksz bytes from @offset are in the readahead buffer */
+static const guint8 *
+fu_chunk_array_readahead(FuChunkArray *self, gsize offset, gsize chunksz, GError **error)
+{
+	gsize bufsz;
+
+	/* already cached */
+	if (self->readahead != NULL && self->readahead->len > 0 &&
+	    offset >= self->readahead_offset &&
+	    offset + chunksz <= self->readahead_offset + self->readahead->len)
+		return self->readahead->data + (offset - self->readahead_offset);
+
+	/* read a block big enough for many chunks */
+	bufsz = MIN(MAX(FU_CHUNK_ARRAY_READAHEAD_SZ, chunksz), self->total_size - offset);
+	if (self->readahead == NULL)
+		self->readahead = g_byte_array_new();
+	g_byte_array_set_size(self->readahead, bufsz);
+	if (!fu_input_stream_read_safe(self->stream,
+				       self->readahead->data,
+				       self->readahead->len,
+				       0x0,
+				       offset,
+				       bufsz,
+				       error)) {
+		g_byte_array_set_size(self->readahead, 0);
+		g_prefix_error(error,
+			       "failed to get stream at 0x%x for 0x%x: ",
+			       (guint)offset,
+			       (guint)bufsz);
+		return NULL;
+	}
+	self->readahead_offset = offset;
+	return self->readahead->data;
+}
+
+/* slices the cached page where possible rather than copying the data again */
+static const guint8 *
+fu_chunk_array_peek_stream(FuChunkArray *self, gsize offset, gsize chunksz, GError **error)
+{
+	if (FU_IS_CACHED_INPUT_STREAM(self->stream)) {
+		const guint8 *data;
+		g_autoptr(GError) error_local = NULL;
+
+		data = fu_cached_input_stream_peek(FU_CACHED_INPUT_STREAM(self->stream),
+						   offset,
+						   chunksz,
+						   &error_local);
+		if (data != NULL)
+			return data;
+		if (!g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			return NULL;
+		}
+	}
+	return fu_chunk_array_readahead(self, offset, chunksz, error);
+}
+
+/**
+ * fu_chunk_array_index_peek:
+ * @self: a #FuChunkArray
+ * @idx: the chunk index
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets a chunk without allocating a new #FuChunk or copying the data.
+ *
+ * The same #FuChunk is reused for every call, and so the returned chunk and its data are only
+ * valid until the next call to this function or fu_chunk_array_index(), or until @self is
+ * destroyed.
+ * For stream-backed arrays, the data is read in large blocks and so iterating the chunks in
+ * order is much faster than using fu_chunk_array_index().
+ *
+ * Returns: (transfer none): a #FuChunk or %NULL if not valid
+ *
+ * Since: 2.1.2
+ **/
+FuChunk *
+fu_chunk_array_index_peek(FuChunkArray *self, guint idx, GError **error)
+{
+	gsize address = 0;
+	gsize chunksz = 0;
+	gsize offset;
+	gsize page = 0;
+	const guint8 *data = NULL;
+
+	g_return_val_if_fail(FU_IS_CHUNK_ARRAY(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	if (idx >= self->offsets->len) {
+		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "idx %u invalid", idx);
+		return NULL;
+	}
+
+	/* calculate address, page and chunk size from the offset */
+	offset = g_array_index(self->offsets, gsize, idx);
+	fu_chunk_array_calculate_chunk_for_offset(self, offset, &address, &page, &chunksz);
+	if (chunksz == 0) {
+		g_set_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA, "idx %u zero sized", idx);
+		return NULL;
+	}
+
+	/* point into the existing data rather than copying */
+	if (self->blob != NULL) {
+		data = (const guint8 *)g_bytes_get_data(self->blob, NULL) + offset;
+	} else if (self->stream != NULL) {
+		data = fu_chunk_array_peek_stream(self, offset, chunksz, error);
+		if (data == NULL)
+			return NULL;
+	}
+
+	/* reuse the same chunk */
+	if (self->chk_peek == NULL)
+		self->chk_peek = fu_chunk_bytes_new(NULL);
+	fu_chunk_set_data(self->chk_peek, data, chunksz);
+	fu_chunk_set_idx(self->chk_peek, idx);
+	fu_chunk_set_page(self->chk_peek, page);
+	fu_chunk_set_address(self->chk_peek, address);
+	return self->chk_peek;
+}
+
 static void
 fu_chunk_array_ensure_offsets(FuChunkArray *self)
 {
@@ -231,6 +358,16 @@ fu_chunk_array_new_virtual(gsize bufsz, gsize addr_offset, gsize page_sz, gsize
 	return g_steal_pointer(&self);
 }
 
+/* a partial stream of a memory or mapped stream is just as cheap to read */
+static gboolean
+fu_chunk_array_stream_is_cached(GInputStream *stream)
+{
+	while (FU_IS_PARTIAL_INPUT_STREAM(stream))
+		stream = fu_partial_input_stream_get_base_stream(FU_PARTIAL_INPUT_STREAM(stream));
+	return G_IS_MEMORY_INPUT_STREAM(stream) || FU_IS_MAPPED_INPUT_STREAM(stream) ||
+	       FU_IS_CACHED_INPUT_STREAM(stream);
+}
+
 /**
  * fu_chunk_array_new_from_stream:
  * @stream: a #GInputStream
@@ -242,6 +379,9 @@ fu_chunk_array_new_virtual(gsize bufsz, gsize addr_offset, gsize page_sz, gsize
  * Chunks a linear stream into packets, ensuring each packet is less that a specific
  * transfer size.
  *
+ * If @stream is not already in memory then it is read in pages using a #FuCachedInputStream so
+ * that small packets do not each cause a seek and read of the base stream.
+ *
  * Returns: (transfer full): a #FuChunkArray, or #NULL on error
  *
  * Since: 2.0.2
@@ -266,7 +406,16 @@ fu_chunk_array_new_from_stream(GInputStream *stream,
 	self->addr_offset = addr_offset;
 	self->page_sz = page_sz;
 	self->packet_sz = packet_sz;
-	self->stream = g_object_ref(stream);
+	if (fu_chunk_array_stream_is_cached(stream)) {
+		self->stream = g_object_ref(stream);
+	} else {
+		self->stream = fu_cached_input_stream_new(stream,
+							  FU_CACHED_INPUT_STREAM_PAGE_SIZE_DEFAULT,
+							  FU_CACHED_INPUT_STREAM_PAGES_MAX_DEFAULT,
+							  error);
+		if (self->stream == NULL)
+			return NULL;
+	}
 
 	/* success */
 	fu_chunk_array_ensure_offsets(self);
@@ -278,6 +427,10 @@ fu_chunk_array_finalize(GObject *object)
 {
 	FuChunkArray *self = FU_CHUNK_ARRAY(object);
 	g_array_unref(self->offsets);
+	if (self->chk_peek != NULL)
+		g_object_unref(self->chk_peek);
+	if (self->readahead != NULL)
+		g_byte_array_unref(self->readahead);
 	if (self->blob != NULL)
 		g_bytes_unref(self->blob);
 	if (self->stream != NULL)
@@ -29,3 +29,5 @@ guint
 fu_chunk_array_length(FuChunkArray *self) G_GNUC_NON_NULL(1);
 FuChunk *
 fu_chunk_array_index(FuChunkArray *self, guint idx, GError **error) G_GNUC_NON_NULL(1);
+FuChunk *
+fu_chunk_array_index_peek(FuChunkArray *self, guint idx, GError **error) G_GNUC_NON_NULL(1);
@@ -200,6 +200,19 @@ fu_chunk_set_data_sz(FuChunk *self, gsize data_sz)
 	self->data_sz = data_sz;
 }
 
+/* private, where @data must outlive the chunk or the next call to this function */
+void
+fu_chunk_set_data(FuChunk *self, const guint8 *data, gsize data_sz)
+{
+	g_return_if_fail(FU_IS_CHUNK(self));
+	if (self->bytes != NULL) {
+		g_bytes_unref(self->bytes);
+		self->bytes = NULL;
+	}
+	self->data = data;
+	self->data_sz = data_sz;
+}
+
 /**
  * fu_chunk_set_bytes:
  * @self: a #FuChunk
@@ -141,7 +141,10 @@ fu_common_crc_func(void)
 	guint8 buf[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
 
 	g_assert_cmpint(fu_crc8(FU_CRC_KIND_B8_STANDARD, buf, sizeof(buf)), ==, (guint8)~0x7A);
+	g_assert_cmpint(fu_crc8(FU_CRC_KIND_B8_MAXIM_DOW, buf, sizeof(buf)), ==, 0xF2);
 	g_assert_cmpint(fu_crc16(FU_CRC_KIND_B16_USB, buf, sizeof(buf)), ==, 0x4DF1);
+	g_assert_cmpint(fu_crc16(FU_CRC_KIND_B16_XMODEM, buf, sizeof(buf)), ==, 0x2378);
+	g_assert_cmpint(fu_crc16(FU_CRC_KIND_B16_KERMIT, buf, sizeof(buf)), ==, 0x4C9A);
 	g_assert_cmpint(fu_crc_misr16(0, buf, (sizeof(buf) / 2) * 2), ==, 0x40D);
 	g_assert_cmpint(fu_crc_misr16(0xFFFF, buf, (sizeof(buf) / 2) * 2), ==, 0xFBFA);
 
@@ -158,6 +161,70 @@ fu_common_crc_func(void)
 	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32Q, buf, sizeof(buf)), ==, 0xE955C875);
 }
 
+static void
+fu_common_crc_find_func(void)
+{
+	gboolean ret;
+	FuCrcKind kind = FU_CRC_KIND_UNKNOWN;
+	guint8 buf[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+	g_autoptr(GArray) kinds = NULL;
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_crc_find(buf, sizeof(buf), 0x5A14B9F9, &kind, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(kind, ==, FU_CRC_KIND_B32C);
+
+	kinds = fu_crc_find_kinds(buf, sizeof(buf), 0x4DF1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(kinds);
+	g_assert_cmpint(kinds->len, ==, 1);
+	g_assert_cmpint(g_array_index(kinds, FuCrcKind, 0), ==, FU_CRC_KIND_B16_USB);
+
+	ret = fu_crc_find(buf, sizeof(buf), 0x12345678, &kind, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false(ret);
+}
+
+static void
+fu_common_crc_hw_func(void)
+{
+	guint8 buf[100] = {0x0};
+
+	/* long enough to use the word-sized instructions when the CPU supports them */
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = (guint8)(i * 7);
+	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32_STANDARD, buf, sizeof(buf)), ==, 0x821D3E85);
+	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32_JAMCRC, buf, sizeof(buf)), ==, 0x7DE2C17A);
+	g_assert_cmpint(fu_crc32(FU_CRC_KIND_B32C, buf, sizeof(buf)), ==, 0xD8AAEAF3);
+}
+
+static void
+fu_common_crc_performance_func(void)
+{
+	gsize bufsz = 0x100000;
+	g_autofree guint8 *buf = g_malloc(bufsz);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)(i * 7);
+	for (guint kind = FU_CRC_KIND_B32_STANDARD; kind < FU_CRC_KIND_LAST; kind++) {
+		guint bitwidth = fu_crc_size(kind);
+		g_timer_reset(timer);
+		for (guint j = 0; j < 10; j++) {
+			if (bitwidth == 32)
+				fu_crc32(kind, buf, bufsz);
+			else if (bitwidth == 16)
+				fu_crc16(kind, buf, bufsz);
+			else
+				fu_crc8(kind, buf, bufsz);
+		}
+		g_debug("%s=%.1fMB/s",
+			fu_crc_kind_to_string(kind),
+			10.f / g_timer_elapsed(timer, NULL));
+	}
+}
+
 static void
 fu_common_guid_func(void)
 {
@@ -231,6 +298,10 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/common/align-up", fu_common_align_up_func);
 	g_test_add_func("/fwupd/common/bitwise", fu_common_bitwise_func);
 	g_test_add_func("/fwupd/common/crc", fu_common_crc_func);
+	g_test_add_func("/fwupd/common/crc/find", fu_common_crc_find_func);
+	g_test_add_func("/fwupd/common/crc/hw", fu_common_crc_hw_func);
+	if (g_test_slow())
+		g_test_add_func("/fwupd/common/crc/performance", fu_common_crc_performance_func);
 	g_test_add_func("/fwupd/common/guid", fu_common_guid_func);
 	g_test_add_func("/fwupd/common/olson-timezone-id", fu_common_olson_timezone_id_func);
 	g_test_add_func("/fwupd/common/cpuid", fu_cpuid_func);
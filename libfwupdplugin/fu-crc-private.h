@@ -24,3 +24,15 @@ guint8
 fu_crc8_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc);
 guint8
 fu_crc8_done(FuCrcKind kind, guint8 crc);
+
+typedef struct {
+	guint32 crc_target;
+	guint32 crcs[FU_CRC_KIND_LAST];
+} FuCrcFindHelper;
+
+void
+fu_crc_find_helper_init(FuCrcFindHelper *helper, guint32 crc_target);
+void
+fu_crc_find_helper_step(FuCrcFindHelper *helper, const guint8 *buf, gsize bufsz);
+GArray *
+fu_crc_find_helper_done(FuCrcFindHelper *helper, GError **error);
@@ -10,10 +10,19 @@
 
 #include <zlib.h>
 
+#ifdef HAVE_CRC32_SSE42
+#include <nmmintrin.h>
+#endif
+#ifdef HAVE_CRC32_ARMV8
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#endif
+
 #include "fu-common.h"
 #include "fu-crc-private.h"
 #include "fu-mem-private.h"
 
+/* nocheck:magic-inlines=100 */
 const struct {
 	FuCrcKind kind;
 	guint bitwidth;
@@ -61,28 +70,200 @@ const struct {
     {FU_CRC_KIND_B8_AUTOSAR, 8, 0x2F, 0xFF, FALSE, 0xFF},
 };
 
-static guint8
-fu_crc_reflect8(guint8 data)
+/* the 32 bit kinds use slice-by-8, the others only need one table */
+#define FU_CRC_TABLE_SLICES 8
+
+/* lookup tables for each kind, built on first use */
+static guint32 *crc_tables[G_N_ELEMENTS(crc_map)];
+
+/* reflected 32 bit kernels using CPU instructions, selected once at runtime */
+typedef guint32 (*FuCrcHwFunc)(guint32 crc, const guint8 *buf, gsize bufsz);
+static FuCrcHwFunc crc_hw_funcs[G_N_ELEMENTS(crc_map)];
+
+static guint32
+fu_crc_reflect32(guint32 data)
 {
-	guint8 val = 0;
-	for (guint8 bit = 0; bit < 8; bit++) {
-		if (data & 0x01)
-			FU_BIT_SET(val, 7 - bit);
-		data = (data >> 1);
-	}
-	return val;
+	data = ((data >> 1) & 0x55555555) | ((data & 0x55555555) << 1);
+	data = ((data >> 2) & 0x33333333) | ((data & 0x33333333) << 2);
+	data = ((data >> 4) & 0x0F0F0F0F) | ((data & 0x0F0F0F0F) << 4);
+	return GUINT32_SWAP_LE_BE(data);
 }
 
 static guint32
 fu_crc_reflect(guint32 data, guint bitwidth)
 {
-	guint32 val = 0;
-	for (guint bit = 0; bit < bitwidth; bit++) {
-		if (data & 0x01)
-			val |= 1ul << ((bitwidth - 1) - bit); /* nocheck:blocked */
-		data = (data >> 1);
+	return fu_crc_reflect32(data) >> (32 - bitwidth);
+}
+
+static guint32
+fu_crc_mask(guint bitwidth)
+{
+	return bitwidth == 32 ? G_MAXUINT32 : (1u << bitwidth) - 1;
+}
+
+static guint32 *
+fu_crc_build_table(FuCrcKind kind)
+{
+	const guint bitwidth = crc_map[kind].bitwidth;
+	const guint slices = bitwidth == 32 ? FU_CRC_TABLE_SLICES : 1;
+	guint32 *tbl = g_new0(guint32, slices * 256);
+
+	/* reflected kinds shift right using the reflected polynomial */
+	if (crc_map[kind].reflected) {
+		guint32 poly = fu_crc_reflect(crc_map[kind].poly, bitwidth);
+		for (guint i = 0; i < 256; i++) {
+			guint32 crc = i;
+			for (guint8 bit = 0; bit < 8; bit++)
+				crc = (crc & 0x1) ? (crc >> 1) ^ poly : crc >> 1;
+			tbl[i] = crc;
+		}
+		for (guint j = 1; j < slices; j++) {
+			for (guint i = 0; i < 256; i++) {
+				guint32 tmp = tbl[((j - 1) * 256) + i];
+				tbl[(j * 256) + i] = (tmp >> 8) ^ tbl[(guint8)tmp];
+			}
+		}
+	} else {
+		guint32 mask = fu_crc_mask(bitwidth);
+		for (guint i = 0; i < 256; i++) {
+			guint32 crc = (guint32)i << (bitwidth - 8);
+			for (guint8 bit = 0; bit < 8; bit++) {
+				if (crc & (1ul << (bitwidth - 1))) {
+					crc = (crc << 1) ^ crc_map[kind].poly;
+				} else {
+					crc = (crc << 1);
+				}
+			}
+			tbl[i] = crc & mask;
+		}
+		for (guint j = 1; j < slices; j++) {
+			for (guint i = 0; i < 256; i++) {
+				guint32 tmp = tbl[((j - 1) * 256) + i];
+				tbl[(j * 256) + i] = (tmp << 8) ^ tbl[tmp >> 24];
+			}
+		}
+	}
+	return tbl;
+}
+
+static const guint32 *
+fu_crc_get_table(FuCrcKind kind)
+{
+	if (g_once_init_enter(&crc_tables[kind]))
+		g_once_init_leave(&crc_tables[kind], fu_crc_build_table(kind));
+	return crc_tables[kind];
+}
+
+#ifdef HAVE_CRC32_SSE42
+__attribute__((target("sse4.2"))) static guint32
+fu_crc32c_sse42(guint32 crc, const guint8 *buf, gsize bufsz)
+{
+	guint64 crc64 = crc;
+	gsize i = 0;
+
+	for (; i + 8 <= bufsz; i += 8)
+		crc64 = _mm_crc32_u64(crc64, fu_memread_uint64(buf + i, G_LITTLE_ENDIAN));
+	crc = (guint32)crc64;
+	for (; i < bufsz; i++)
+		crc = _mm_crc32_u8(crc, buf[i]);
+	return crc;
+}
+#endif
+
+#ifdef HAVE_CRC32_ARMV8
+__attribute__((target("+crc"))) static guint32
+fu_crc32c_armv8(guint32 crc, const guint8 *buf, gsize bufsz)
+{
+	gsize i = 0;
+
+	for (; i + 8 <= bufsz; i += 8)
+		crc = __crc32cd(crc, fu_memread_uint64(buf + i, G_LITTLE_ENDIAN));
+	for (; i < bufsz; i++)
+		crc = __crc32cb(crc, buf[i]);
+	return crc;
+}
+
+__attribute__((target("+crc"))) static guint32
+fu_crc32_armv8(guint32 crc, const guint8 *buf, gsize bufsz)
+{
+	gsize i = 0;
+
+	for (; i + 8 <= bufsz; i += 8)
+		crc = __crc32d(crc, fu_memread_uint64(buf + i, G_LITTLE_ENDIAN));
+	for (; i < bufsz; i++)
+		crc = __crc32b(crc, buf[i]);
+	return crc;
+}
+#endif
+
+static void
+fu_crc_hw_funcs_setup(void)
+{
+#ifdef HAVE_CRC32_SSE42
+	if (__builtin_cpu_supports("sse4.2"))
+		crc_hw_funcs[FU_CRC_KIND_B32C] = fu_crc32c_sse42;
+#endif
+#ifdef HAVE_CRC32_ARMV8
+	if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+		crc_hw_funcs[FU_CRC_KIND_B32C] = fu_crc32c_armv8;
+		crc_hw_funcs[FU_CRC_KIND_B32_STANDARD] = fu_crc32_armv8;
+		crc_hw_funcs[FU_CRC_KIND_B32_JAMCRC] = fu_crc32_armv8;
 	}
-	return val;
+#endif
+}
+
+static FuCrcHwFunc
+fu_crc_get_hw_func(FuCrcKind kind)
+{
+	static gsize hw_funcs_setup = 0;
+	if (g_once_init_enter(&hw_funcs_setup)) {
+		fu_crc_hw_funcs_setup();
+		g_once_init_leave(&hw_funcs_setup, 1);
+	}
+	return crc_hw_funcs[kind];
+}
+
+/* the register is always kept in the non-reflected form between calls */
+static guint32
+fu_crc_step_table(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	const guint bitwidth = crc_map[kind].bitwidth;
+	const guint32 mask = fu_crc_mask(bitwidth);
+	const guint32 *tbl = fu_crc_get_table(kind);
+	gsize i = 0;
+
+	if (crc_map[kind].reflected) {
+		FuCrcHwFunc hw_func = fu_crc_get_hw_func(kind);
+		crc = fu_crc_reflect(crc, bitwidth);
+		if (hw_func != NULL)
+			return fu_crc_reflect(hw_func(crc, buf, bufsz), bitwidth);
+		if (bitwidth == 32) {
+			for (; i + 8 <= bufsz; i += 8) {
+				guint32 one = crc ^ fu_memread_uint32(buf + i, G_LITTLE_ENDIAN);
+				crc = tbl[(7 * 256) + (guint8)one] ^ tbl[(6 * 256) + (guint8)(one >> 8)] ^
+				      tbl[(5 * 256) + (guint8)(one >> 16)] ^
+				      tbl[(4 * 256) + (one >> 24)] ^ tbl[(3 * 256) + buf[i + 4]] ^
+				      tbl[(2 * 256) + buf[i + 5]] ^ tbl[(1 * 256) + buf[i + 6]] ^
+				      tbl[buf[i + 7]];
+			}
+		}
+		for (; i < bufsz; i++)
+			crc = (crc >> 8) ^ tbl[(guint8)(crc ^ buf[i])];
+		return fu_crc_reflect(crc, bitwidth);
+	}
+
+	if (bitwidth == 32) {
+		for (; i + 8 <= bufsz; i += 8) {
+			guint32 one = crc ^ fu_memread_uint32(buf + i, G_BIG_ENDIAN);
+			crc = tbl[(7 * 256) + (one >> 24)] ^ tbl[(6 * 256) + (guint8)(one >> 16)] ^
+			      tbl[(5 * 256) + (guint8)(one >> 8)] ^ tbl[(4 * 256) + (guint8)one] ^
+			      tbl[(3 * 256) + buf[i + 4]] ^ tbl[(2 * 256) + buf[i + 5]] ^
+			      tbl[(1 * 256) + buf[i + 6]] ^ tbl[buf[i + 7]];
+		}
+	}
+	for (; i < bufsz; i++)
+		crc = ((crc << 8) ^ tbl[(guint8)((crc >> (bitwidth - 8)) ^ buf[i])]) & mask;
+	return crc;
 }
 
 /**
@@ -120,22 +301,9 @@ fu_crc_size(FuCrcKind kind)
 guint8
 fu_crc8_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint8 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 8, 0x0);
-
-	for (gsize i = 0; i < bufsz; ++i) {
-		crc ^= crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
-	}
-	return crc;
+	return fu_crc_step_table(kind, buf, bufsz, crc);
 }
 
 /**
@@ -256,23 +424,9 @@ fu_crc8_bytes(FuCrcKind kind, GBytes *blob)
 guint16
 fu_crc16_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint16 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 16, 0x0);
-
-	for (gsize i = 0; i < bufsz; ++i) {
-		guint16 tmp = crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		crc ^= tmp << (bitwidth - 8);
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
-	}
-	return crc;
+	return fu_crc_step_table(kind, buf, bufsz, crc);
 }
 
 /**
@@ -393,23 +547,9 @@ fu_crc16_bytes(FuCrcKind kind, GBytes *blob)
 guint32
 fu_crc32_step(FuCrcKind kind, const guint8 *buf, gsize bufsz, guint32 crc)
 {
-	const guint bitwidth = sizeof(crc) * 8;
-
 	g_return_val_if_fail(kind < FU_CRC_KIND_LAST, 0x0);
 	g_return_val_if_fail(crc_map[kind].bitwidth == 32, 0x0);
-
-	for (gsize i = 0; i < bufsz; ++i) {
-		guint32 tmp = crc_map[kind].reflected ? fu_crc_reflect8(buf[i]) : buf[i];
-		crc ^= tmp << (bitwidth - 8);
-		for (guint8 bit = 0; bit < 8; bit++) {
-			if (crc & (1ul << (bitwidth - 1))) {
-				crc = (crc << 1) ^ crc_map[kind].poly;
-			} else {
-				crc = (crc << 1);
-			}
-		}
-	}
-	return crc;
+	return fu_crc_step_table(kind, buf, bufsz, crc);
 }
 
 /**
@@ -536,6 +676,101 @@ fu_crc32_bytes(FuCrcKind kind, GBytes *blob)
 	return fu_crc32(kind, g_bytes_get_data(blob, NULL), g_bytes_get_size(blob));
 }
 
+/* small enough that each block stays in the CPU cache for every kind */
+#define FU_CRC_FIND_BLOCK_SIZE 0x4000
+
+static gboolean
+fu_crc_find_helper_is_candidate(FuCrcFindHelper *helper, FuCrcKind kind)
+{
+	if (kind == FU_CRC_KIND_UNKNOWN)
+		return FALSE;
+	if (crc_map[kind].bitwidth == 16 && helper->crc_target > G_MAXUINT16)
+		return FALSE;
+	if (crc_map[kind].bitwidth == 8 && helper->crc_target > G_MAXUINT8)
+		return FALSE;
+	return TRUE;
+}
+
+/* private */
+void
+fu_crc_find_helper_init(FuCrcFindHelper *helper, guint32 crc_target)
+{
+	helper->crc_target = crc_target;
+	for (guint i = 0; i < G_N_ELEMENTS(crc_map); i++)
+		helper->crcs[i] = crc_map[i].init;
+}
+
+/* private */
+void
+fu_crc_find_helper_step(FuCrcFindHelper *helper, const guint8 *buf, gsize bufsz)
+{
+	for (gsize offset = 0; offset < bufsz; offset += FU_CRC_FIND_BLOCK_SIZE) {
+		gsize blocksz = MIN(bufsz - offset, FU_CRC_FIND_BLOCK_SIZE);
+		for (guint i = 0; i < G_N_ELEMENTS(crc_map); i++) {
+			if (!fu_crc_find_helper_is_candidate(helper, i))
+				continue;
+			helper->crcs[i] = fu_crc_step_table(i, buf + offset, blocksz, helper->crcs[i]);
+		}
+	}
+}
+
+/* private */
+GArray *
+fu_crc_find_helper_done(FuCrcFindHelper *helper, GError **error)
+{
+	g_autoptr(GArray) kinds = g_array_new(FALSE, FALSE, sizeof(FuCrcKind));
+
+	for (guint i = 0; i < G_N_ELEMENTS(crc_map); i++) {
+		FuCrcKind kind = crc_map[i].kind;
+		guint32 crc = helper->crcs[i];
+		if (!fu_crc_find_helper_is_candidate(helper, kind))
+			continue;
+		if (crc_map[i].reflected)
+			crc = fu_crc_reflect(crc, crc_map[i].bitwidth);
+		crc ^= crc_map[i].xorout;
+		if (crc != helper->crc_target)
+			continue;
+		g_debug("matched %s", fu_crc_kind_to_string(kind));
+		g_array_append_val(kinds, kind);
+	}
+	if (kinds->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_FOUND,
+				    "no CRC kind matched");
+		return NULL;
+	}
+	return g_steal_pointer(&kinds);
+}
+
+/**
+ * fu_crc_find_kinds:
+ * @buf: memory buffer
+ * @bufsz: size of @buf
+ * @crc_target: "correct" CRC value
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns all the cyclic redundancy kinds that match the given memory buffer and target CRC.
+ *
+ * Every candidate kind is computed in a single pass over @buf.
+ *
+ * Returns: (transfer full) (element-type FuCrcKind): kinds, or %NULL if none matched
+ *
+ * Since: 2.1.2
+ **/
+GArray *
+fu_crc_find_kinds(const guint8 *buf, gsize bufsz, guint32 crc_target, GError **error)
+{
+	FuCrcFindHelper helper = {0};
+
+	g_return_val_if_fail(buf != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	fu_crc_find_helper_init(&helper, crc_target);
+	fu_crc_find_helper_step(&helper, buf, bufsz);
+	return fu_crc_find_helper_done(&helper, error);
+}
+
 /**
  * fu_crc_find:
  * @buf: memory buffer
@@ -551,6 +786,8 @@ fu_crc32_bytes(FuCrcKind kind, GBytes *blob)
  *    guint8 buf[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
  *    g_info("CRC:%u", fu_crc_find(buf, sizeof(buf), _custom_crc(buf, sizeof(buf))));
  *
+ * Use fu_crc_find_kinds() if more than one kind may match.
+ *
  * Returns: %TRUE if one well-known CRC kind was found.
  *
  * Since: 2.1.1
@@ -558,41 +795,12 @@ fu_crc32_bytes(FuCrcKind kind, GBytes *blob)
 gboolean
 fu_crc_find(const guint8 *buf, gsize bufsz, guint32 crc_target, FuCrcKind *kind, GError **error)
 {
-	FuCrcKind kind_tmp = FU_CRC_KIND_UNKNOWN;
-	guint match_cnt = 0;
-	for (guint i = 0; i < G_N_ELEMENTS(crc_map); i++) {
-		if (crc_map[i].bitwidth == 32) {
-			if (crc_target == fu_crc32(crc_map[i].kind, buf, bufsz)) {
-				g_debug("matched %s", fu_crc_kind_to_string(crc_map[i].kind));
-				kind_tmp = crc_map[i].kind;
-				match_cnt++;
-			}
-		}
-		if (crc_target <= G_MAXUINT16 && crc_map[i].bitwidth == 16) {
-			if ((guint16)crc_target == fu_crc16(crc_map[i].kind, buf, bufsz)) {
-				g_debug("matched %s", fu_crc_kind_to_string(crc_map[i].kind));
-				kind_tmp = crc_map[i].kind;
-				match_cnt++;
-			}
-		}
-		if (crc_target <= G_MAXUINT8 && crc_map[i].bitwidth == 8) {
-			if ((guint8)crc_target == fu_crc8(crc_map[i].kind, buf, bufsz)) {
-				g_debug("matched %s", fu_crc_kind_to_string(crc_map[i].kind));
-				kind_tmp = crc_map[i].kind;
-				match_cnt++;
-			}
-		}
-	}
+	g_autoptr(GArray) kinds = NULL;
 
-	/* failed */
-	if (match_cnt == 0) {
-		g_set_error_literal(error,
-				    FWUPD_ERROR,
-				    FWUPD_ERROR_NOT_FOUND,
-				    "no CRC kind matched");
+	kinds = fu_crc_find_kinds(buf, bufsz, crc_target, error);
+	if (kinds == NULL)
 		return FALSE;
-	}
-	if (match_cnt > 1) {
+	if (kinds->len > 1) {
 		g_set_error_literal(error,
 				    FWUPD_ERROR,
 				    FWUPD_ERROR_NOT_FOUND,
@@ -602,7 +810,7 @@ fu_crc_find(const guint8 *buf, gsize bufsz, guint32 crc_target, FuCrcKind *kind,
 
 	/* success */
 	if (kind != NULL)
-		*kind = kind_tmp;
+		*kind = g_array_index(kinds, FuCrcKind, 0);
 	return TRUE;
 }
 
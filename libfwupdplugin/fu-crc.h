@@ -52,6 +52,9 @@ fu_crc8_bytes(FuCrcKind kind, GBytes *blob);
 
 gboolean
 fu_crc_find(const guint8 *buf, gsize bufsz, guint32 crc_target, FuCrcKind *kind, GError **error);
+GArray *
+fu_crc_find_kinds(const guint8 *buf, gsize bufsz, guint32 crc_target, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 
 guint16
 fu_crc_misr16(guint16 init, const guint8 *buf, gsize bufsz);
@@ -151,6 +151,75 @@ fu_device_event_strict_order_func(void)
 	g_assert_null(event_tmp);
 }
 
+static void
+fu_device_event_repeated_func(void)
+{
+	FuDeviceEvent *event_tmp;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(FuDeviceEvent) event1 = fu_device_event_new("foo:bar:baz");
+	g_autoptr(FuDeviceEvent) event2 = fu_device_event_new("aaa:bbb:ccc");
+	g_autoptr(FuDeviceEvent) event3 = fu_device_event_new("foo:bar:baz");
+	g_autoptr(GError) error = NULL;
+
+	fu_device_add_event(device, event1);
+	fu_device_add_event(device, event2);
+	fu_device_add_event(device, event3);
+
+	/* skips forward, then finds the next one with the same ID */
+	event_tmp = fu_device_load_event(device, "aaa:bbb:ccc", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event2);
+	event_tmp = fu_device_load_event(device, "foo:bar:baz", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event3);
+
+	/* wraps around */
+	event_tmp = fu_device_load_event(device, "foo:bar:baz", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event1);
+	event_tmp = fu_device_load_event(device, "aaa:bbb:ccc", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event2);
+
+	/* only exists before the current position */
+	event_tmp = fu_device_load_event(device, "aaa:bbb:ccc", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(event_tmp);
+	g_clear_error(&error);
+
+	/* events added after the first load */
+	fu_device_clear_events(device);
+	fu_device_add_event(device, event2);
+	event_tmp = fu_device_load_event(device, "aaa:bbb:ccc", &error);
+	g_assert_no_error(error);
+	g_assert_true(event_tmp == event2);
+}
+
+static void
+fu_device_event_performance_func(void)
+{
+	guint n_events = 50000;
+	g_autoptr(FuDevice) device = fu_device_new(NULL);
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* a typical recording repeats a few requests many times */
+	for (guint i = 0; i < n_events; i++) {
+		g_autofree gchar *id = g_strdup_printf("Usb:ControlTransfer:%02x", i % 100);
+		g_autoptr(FuDeviceEvent) event = fu_device_event_new(id);
+		fu_device_add_event(device, event);
+	}
+	g_timer_reset(timer);
+	for (guint i = 0; i < n_events; i++) {
+		FuDeviceEvent *event;
+		g_autofree gchar *id = g_strdup_printf("Usb:ControlTransfer:%02x", i % 100);
+		g_autoptr(GError) error = NULL;
+		event = fu_device_load_event(device, id, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(event);
+	}
+	g_debug("replayed %u events in %.1fms", n_events, g_timer_elapsed(timer, NULL) * 1000);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -159,5 +228,10 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/device-event/uncompressed", fu_device_event_uncompressed_func);
 	g_test_add_func("/fwupd/device-event/donor", fu_device_event_donor_func);
 	g_test_add_func("/fwupd/device-event/strict-order", fu_device_event_strict_order_func);
+	g_test_add_func("/fwupd/device-event/repeated", fu_device_event_repeated_func);
+	if (g_test_slow()) {
+		g_test_add_func("/fwupd/device-event/performance",
+				fu_device_event_performance_func);
+	}
 	return g_test_run();
 }
@@ -74,6 +74,9 @@ typedef struct {
 	GPtrArray *parent_physical_ids; /* (nullable) */
 	GPtrArray *parent_backend_ids;	/* (nullable) */
 	GPtrArray *events;		/* (nullable) (element-type FuDeviceEvent) */
+	GHashTable *event_positions;	/* (nullable) (element-type utf8 GArray) */
+	guint event_positions_len;	/* number of events in event_positions */
+	GHashTable *event_id_hashes;	/* (nullable) (element-type utf8 utf8) */
 	guint event_idx;
 	guint remove_delay;    /* ms */
 	guint acquiesce_delay; /* ms */
@@ -8089,6 +8092,89 @@ fu_device_security_attr_new(FuDevice *self, const gchar *appstream_id)
 	return g_steal_pointer(&attr);
 }
 
+/* so that loading an event from an unbounded set of IDs does not use unbounded memory */
+#define FU_DEVICE_EVENT_ID_HASHES_MAX 10000
+
+static void
+fu_device_invalidate_event_positions(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	if (priv->event_positions != NULL)
+		g_hash_table_remove_all(priv->event_positions);
+	priv->event_positions_len = 0;
+}
+
+/* indexes any events added since the last call, even if added with fu_device_get_events() */
+static void
+fu_device_ensure_event_positions(FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+
+	if (priv->event_positions == NULL) {
+		priv->event_positions = g_hash_table_new_full(g_str_hash,
+							      g_str_equal,
+							      g_free,
+							      (GDestroyNotify)g_array_unref);
+	}
+	if (priv->event_positions_len > priv->events->len)
+		fu_device_invalidate_event_positions(self);
+	for (guint i = priv->event_positions_len; i < priv->events->len; i++) {
+		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
+		const gchar *event_id = fu_device_event_get_id(event);
+		GArray *positions;
+
+		if (event_id == NULL)
+			continue;
+		positions = g_hash_table_lookup(priv->event_positions, event_id);
+		if (positions == NULL) {
+			positions = g_array_new(FALSE, FALSE, sizeof(guint));
+			g_hash_table_insert(priv->event_positions, g_strdup(event_id), positions);
+		}
+		g_array_append_val(positions, i);
+	}
+	priv->event_positions_len = priv->events->len;
+}
+
+/* returns the first position that is not before @idx, or %G_MAXUINT */
+static guint
+fu_device_event_positions_find(GArray *positions, guint idx)
+{
+	guint lo = 0;
+	guint hi = positions->len;
+
+	/* replaying in order, so usually the first one */
+	if (g_array_index(positions, guint, 0) >= idx)
+		return g_array_index(positions, guint, 0);
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		if (g_array_index(positions, guint, mid) < idx)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == positions->len)
+		return G_MAXUINT;
+	return g_array_index(positions, guint, lo);
+}
+
+static const gchar *
+fu_device_build_event_id(FuDevice *self, const gchar *id)
+{
+	FuDevicePrivate *priv = GET_PRIVATE(self);
+	gchar *id_hash;
+
+	if (priv->event_id_hashes == NULL)
+		priv->event_id_hashes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	id_hash = g_hash_table_lookup(priv->event_id_hashes, id);
+	if (id_hash != NULL)
+		return id_hash;
+	if (g_hash_table_size(priv->event_id_hashes) >= FU_DEVICE_EVENT_ID_HASHES_MAX)
+		g_hash_table_remove_all(priv->event_id_hashes);
+	id_hash = fu_device_event_build_id(id);
+	g_hash_table_insert(priv->event_id_hashes, g_strdup(id), id_hash);
+	return id_hash;
+}
+
 static void
 fu_device_ensure_events(FuDevice *self)
 {
@@ -8124,8 +8210,10 @@ fu_device_add_event(FuDevice *self, FuDeviceEvent *event)
 	fu_device_ensure_events(self);
 
 	/* fuzzing */
-	if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_IS_FAKE))
+	if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_IS_FAKE)) {
 		g_ptr_array_set_size(priv->events, 0);
+		fu_device_invalidate_event_positions(self);
+	}
 
 	g_ptr_array_add(priv->events, g_object_ref(event));
 }
@@ -8177,7 +8265,10 @@ FuDeviceEvent *
 fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 {
 	FuDevicePrivate *priv = GET_PRIVATE(self);
-	g_autofree gchar *id_hash = NULL;
+	FuDeviceEvent *event;
+	GArray *positions;
+	const gchar *id_hash;
+	guint idx;
 
 	g_return_val_if_fail(FU_IS_DEVICE(self), NULL);
 	g_return_val_if_fail(id != NULL, NULL);
@@ -8202,9 +8293,8 @@ fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 		return g_ptr_array_index(priv->events, 0);
 
 	/* in strict ordering mode */
-	id_hash = fu_device_event_build_id(id);
+	id_hash = fu_device_build_event_id(self, id);
 	if (fu_device_has_private_flag(self, FU_DEVICE_PRIVATE_FLAG_STRICT_EMULATION_ORDER)) {
-		FuDeviceEvent *event;
 		if (priv->event_idx >= priv->events->len) {
 			g_set_error(error,
 				    FWUPD_ERROR,
@@ -8244,13 +8334,15 @@ fu_device_load_event(FuDevice *self, const gchar *id, GError **error)
 	}
 
 	/* look for the next event in the sequence */
-	for (guint i = priv->event_idx; i < priv->events->len; i++) {
-		FuDeviceEvent *event = g_ptr_array_index(priv->events, i);
-		if (g_strcmp0(fu_device_event_get_id(event), id_hash) == 0) {
-			priv->event_idx = i + 1;
-			g_debug("found event with ID %s [%s]", id, id_hash);
-			return event;
-		}
+	fu_device_ensure_event_positions(self);
+	positions = g_hash_table_lookup(priv->event_positions, id_hash);
+	idx = positions != NULL ? fu_device_event_positions_find(positions, priv->event_idx)
+				: G_MAXUINT;
+	if (idx != G_MAXUINT) {
+		event = g_ptr_array_index(priv->events, idx);
+		priv->event_idx = idx + 1;
+		g_debug("found event with ID %s [%s]", id, id_hash);
+		return event;
 	}
 
 	/* nothing found */
@@ -8316,6 +8408,7 @@ fu_device_clear_events(FuDevice *self)
 	if (priv->events == NULL)
 		return;
 	g_ptr_array_set_size(priv->events, 0);
+	fu_device_invalidate_event_positions(self);
 	priv->event_idx = 0;
 }
 
@@ -8793,6 +8886,10 @@ fu_device_finalize(GObject *object)
 		g_ptr_array_unref(priv->parent_backend_ids);
 	if (priv->events != NULL)
 		g_ptr_array_unref(priv->events);
+	if (priv->event_positions != NULL)
+		g_hash_table_unref(priv->event_positions);
+	if (priv->event_id_hashes != NULL)
+		g_hash_table_unref(priv->event_id_hashes);
 	if (priv->retry_recs != NULL)
 		g_ptr_array_unref(priv->retry_recs);
 	if (priv->instance_ids != NULL)
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+static void
+fu_digest_sum_func(void)
+{
+	guint8 buf[0x100] = {0x0};
+
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = (guint8)g_test_rand_int();
+
+	/* compare with the trivial implementations for all sizes and alignments */
+	for (gsize offset = 0; offset < 8; offset++) {
+		for (gsize bufsz = 0; bufsz < sizeof(buf) - offset; bufsz++) {
+			const guint8 *tmp = buf + offset;
+			guint32 sum = 0;
+			guint8 xor8 = 0;
+
+			for (gsize i = 0; i < bufsz; i++) {
+				sum += tmp[i];
+				xor8 ^= tmp[i];
+			}
+			g_assert_cmpint(fu_sum8(tmp, bufsz), ==, (guint8)sum);
+			g_assert_cmpint(fu_sum16(tmp, bufsz), ==, (guint16)sum);
+			g_assert_cmpint(fu_sum32(tmp, bufsz), ==, sum);
+			g_assert_cmpint(fu_xor8(tmp, bufsz), ==, xor8);
+			if (bufsz % 2 == 0) {
+				guint16 sum16_le = 0;
+				guint16 sum16_be = 0;
+				for (gsize i = 0; i < bufsz; i += 2) {
+					sum16_le += fu_memread_uint16(tmp + i, G_LITTLE_ENDIAN);
+					sum16_be += fu_memread_uint16(tmp + i, G_BIG_ENDIAN);
+				}
+				g_assert_cmpint(fu_sum16w(tmp, bufsz, G_LITTLE_ENDIAN),
+						==,
+						sum16_le);
+				g_assert_cmpint(fu_sum16w(tmp, bufsz, G_BIG_ENDIAN),
+						==,
+						sum16_be);
+			}
+			if (bufsz % 4 == 0) {
+				guint32 sum32_le = 0;
+				guint32 sum32_be = 0;
+				for (gsize i = 0; i < bufsz; i += 4) {
+					sum32_le += fu_memread_uint32(tmp + i, G_LITTLE_ENDIAN);
+					sum32_be += fu_memread_uint32(tmp + i, G_BIG_ENDIAN);
+				}
+				g_assert_cmpint(fu_sum32w(tmp, bufsz, G_LITTLE_ENDIAN),
+						==,
+						sum32_le);
+				g_assert_cmpint(fu_sum32w(tmp, bufsz, G_BIG_ENDIAN),
+						==,
+						sum32_be);
+			}
+		}
+	}
+}
+
+static void
+fu_digest_func(void)
+{
+	gsize offset = 0;
+	guint8 buf[0x1000] = {0x0};
+	g_autofree gchar *sha256 = NULL;
+	g_autofree gchar *sha1 = NULL;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuDigest) digest = NULL;
+
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = (guint8)g_test_rand_int();
+
+	/* add in odd-sized chunks */
+	digest = fu_digest_new(FU_DIGEST_KIND_SUM8 | FU_DIGEST_KIND_SUM16W_LE |
+			       FU_DIGEST_KIND_SUM16W_BE | FU_DIGEST_KIND_SUM32W_LE |
+			       FU_DIGEST_KIND_SUM32W_BE | FU_DIGEST_KIND_XOR8 |
+			       FU_DIGEST_KIND_CRC32 | FU_DIGEST_KIND_SHA256);
+	for (gsize i = 1; offset < sizeof(buf); i += 2) {
+		gsize chunksz = MIN(i, sizeof(buf) - offset);
+		fu_digest_update(digest, buf + offset, chunksz);
+		offset += chunksz;
+	}
+	g_assert_cmpint(fu_digest_get_size(digest), ==, sizeof(buf));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_SUM8),
+			==,
+			fu_sum8(buf, sizeof(buf)));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_SUM16W_LE),
+			==,
+			fu_sum16w(buf, sizeof(buf), G_LITTLE_ENDIAN));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_SUM16W_BE),
+			==,
+			fu_sum16w(buf, sizeof(buf), G_BIG_ENDIAN));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_SUM32W_LE),
+			==,
+			fu_sum32w(buf, sizeof(buf), G_LITTLE_ENDIAN));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_SUM32W_BE),
+			==,
+			fu_sum32w(buf, sizeof(buf), G_BIG_ENDIAN));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_XOR8),
+			==,
+			fu_xor8(buf, sizeof(buf)));
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_CRC32),
+			==,
+			fu_crc32(FU_CRC_KIND_B32_STANDARD, buf, sizeof(buf)));
+	sha256 = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA256);
+	str = g_compute_checksum_for_data(G_CHECKSUM_SHA256, buf, sizeof(buf));
+	g_assert_cmpstr(sha256, ==, str);
+
+	/* still usable after getting the hash */
+	fu_digest_update(digest, buf, sizeof(buf));
+	g_assert_cmpint(fu_digest_get_size(digest), ==, 2 * sizeof(buf));
+
+	/* not requested */
+	g_test_expect_message("FuDigest", G_LOG_LEVEL_CRITICAL, "*assertion*");
+	sha1 = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA1);
+	g_assert_null(sha1);
+}
+
+static void
+fu_digest_stream_func(void)
+{
+	gboolean ret;
+	guint8 sum8 = 0;
+	guint32 crc32 = G_MAXUINT32;
+	g_autofree gchar *sha256 = NULL;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuDigest) digest = NULL;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* more than one chunk */
+	for (guint i = 0; i < 1024 * 1024; i++)
+		fu_byte_array_append_uint8(buf, (guint8)i);
+	stream = g_memory_input_stream_new_from_data(buf->data, buf->len, NULL);
+
+	/* one pass at a time */
+	ret = fu_input_stream_compute_sum8(stream, &sum8, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_input_stream_compute_crc32(stream, FU_CRC_KIND_B32_STANDARD, &crc32, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	str = fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(str);
+
+	/* all at once */
+	digest = fu_digest_new(FU_DIGEST_KIND_SUM8 | FU_DIGEST_KIND_CRC32 | FU_DIGEST_KIND_SHA256);
+	ret = fu_digest_update_stream(digest, stream, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_SUM8), ==, sum8);
+	g_assert_cmpint(fu_digest_get_value(digest, FU_DIGEST_KIND_CRC32), ==, crc32);
+	sha256 = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA256);
+	g_assert_cmpstr(sha256, ==, str);
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/digest/sum", fu_digest_sum_func);
+	g_test_add_func("/fwupd/digest", fu_digest_func);
+	g_test_add_func("/fwupd/digest/stream", fu_digest_stream_func);
+	return g_test_run();
+}
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuDigest"
+
+#include "config.h"
+
+#include "fu-crc-private.h"
+#include "fu-digest.h"
+#include "fu-input-stream.h"
+#include "fu-sum-private.h"
+#include "fu-xor.h"
+
+/**
+ * FuDigest:
+ *
+ * Compute several checksums, CRCs and cryptographic hashes of the same data in one pass.
+ *
+ * The data can be added in any number of chunks of any size, so a large image only has to be
+ * read once even when multiple digests are required.
+ */
+
+#define FU_DIGEST_KIND_SUM_ANY                                                                     \
+	(FU_DIGEST_KIND_SUM8 | FU_DIGEST_KIND_SUM16 | FU_DIGEST_KIND_SUM16W_LE |                   \
+	 FU_DIGEST_KIND_SUM16W_BE | FU_DIGEST_KIND_SUM32 | FU_DIGEST_KIND_SUM32W_LE |              \
+	 FU_DIGEST_KIND_SUM32W_BE)
+
+#define FU_DIGEST_CHECKSUM_TYPES 4
+
+struct _FuDigest {
+	GObject parent_instance;
+	FuDigestKind kinds;
+	gsize size;
+	guint64 lanes[FU_SUM_LANES];
+	guint8 xor8;
+	guint32 crc32;
+	GChecksum *checksums[FU_DIGEST_CHECKSUM_TYPES]; /* nullable */
+};
+
+G_DEFINE_TYPE(FuDigest, fu_digest, G_TYPE_OBJECT)
+
+static FuDigestKind
+fu_digest_checksum_idx_to_kind(guint idx)
+{
+	if (idx == 0)
+		return FU_DIGEST_KIND_SHA1;
+	if (idx == 1)
+		return FU_DIGEST_KIND_SHA256;
+	if (idx == 2)
+		return FU_DIGEST_KIND_SHA384;
+	if (idx == 3)
+		return FU_DIGEST_KIND_SHA512;
+	return FU_DIGEST_KIND_NONE;
+}
+
+static GChecksumType
+fu_digest_checksum_idx_to_type(guint idx)
+{
+	if (idx == 0)
+		return G_CHECKSUM_SHA1;
+	if (idx == 1)
+		return G_CHECKSUM_SHA256;
+	if (idx == 2)
+		return G_CHECKSUM_SHA384;
+	return G_CHECKSUM_SHA512;
+}
+
+/**
+ * fu_digest_kind_from_checksum_type:
+ * @checksum_type: a #GChecksumType, e.g. %G_CHECKSUM_SHA256
+ *
+ * Converts a GLib checksum type to the equivalent digest kind.
+ *
+ * Returns: a #FuDigestKind, or %FU_DIGEST_KIND_NONE if not supported
+ *
+ * Since: 2.1.2
+ **/
+FuDigestKind
+fu_digest_kind_from_checksum_type(GChecksumType checksum_type)
+{
+	for (guint i = 0; i < FU_DIGEST_CHECKSUM_TYPES; i++) {
+		if (fu_digest_checksum_idx_to_type(i) == checksum_type)
+			return fu_digest_checksum_idx_to_kind(i);
+	}
+	return FU_DIGEST_KIND_NONE;
+}
+
+/**
+ * fu_digest_get_kinds:
+ * @self: a #FuDigest
+ *
+ * Gets the digests being computed.
+ *
+ * Returns: a #FuDigestKind bitfield, e.g. %FU_DIGEST_KIND_SUM8
+ *
+ * Since: 2.1.2
+ **/
+FuDigestKind
+fu_digest_get_kinds(FuDigest *self)
+{
+	g_return_val_if_fail(FU_IS_DIGEST(self), FU_DIGEST_KIND_NONE);
+	return self->kinds;
+}
+
+/**
+ * fu_digest_get_size:
+ * @self: a #FuDigest
+ *
+ * Gets the total number of bytes added so far.
+ *
+ * Returns: size in bytes
+ *
+ * Since: 2.1.2
+ **/
+gsize
+fu_digest_get_size(FuDigest *self)
+{
+	g_return_val_if_fail(FU_IS_DIGEST(self), 0);
+	return self->size;
+}
+
+/**
+ * fu_digest_update:
+ * @self: a #FuDigest
+ * @buf: (nullable): memory buffer
+ * @bufsz: size of @buf
+ *
+ * Adds the next chunk of data to all the requested digests.
+ *
+ * The word sums do not require @bufsz to be aligned, as the position of each byte in the
+ * complete image is tracked between calls.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_digest_update(FuDigest *self, const guint8 *buf, gsize bufsz)
+{
+	g_return_if_fail(FU_IS_DIGEST(self));
+	g_return_if_fail(buf != NULL || bufsz == 0);
+
+	if (bufsz == 0)
+		return;
+	if (self->kinds & FU_DIGEST_KIND_SUM_ANY)
+		fu_sum_lanes(buf, bufsz, self->size, self->lanes);
+	if (self->kinds & FU_DIGEST_KIND_XOR8)
+		self->xor8 ^= fu_xor8(buf, bufsz);
+	if (self->kinds & FU_DIGEST_KIND_CRC32)
+		self->crc32 = fu_crc32_fast(buf, bufsz, self->crc32);
+	for (guint i = 0; i < FU_DIGEST_CHECKSUM_TYPES; i++) {
+		if (self->checksums[i] != NULL)
+			g_checksum_update(self->checksums[i], buf, bufsz);
+	}
+	self->size += bufsz;
+}
+
+/**
+ * fu_digest_update_bytes:
+ * @self: a #FuDigest
+ * @blob: a #GBytes
+ *
+ * Adds the next chunk of data to all the requested digests.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_digest_update_bytes(FuDigest *self, GBytes *blob)
+{
+	gsize bufsz = 0;
+	const guint8 *buf;
+
+	g_return_if_fail(FU_IS_DIGEST(self));
+	g_return_if_fail(blob != NULL);
+
+	buf = g_bytes_get_data(blob, &bufsz);
+	fu_digest_update(self, buf, bufsz);
+}
+
+static gboolean
+fu_digest_update_stream_cb(const guint8 *buf, gsize bufsz, gpointer user_data, GError **error)
+{
+	FuDigest *self = FU_DIGEST(user_data);
+	fu_digest_update(self, buf, bufsz);
+	return TRUE;
+}
+
+/**
+ * fu_digest_update_stream:
+ * @self: a #FuDigest
+ * @stream: a #GInputStream
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds all the data from @stream to all the requested digests, reading it only once.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.2
+ **/
+gboolean
+fu_digest_update_stream(FuDigest *self, GInputStream *stream, GError **error)
+{
+	g_return_val_if_fail(FU_IS_DIGEST(self), FALSE);
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+	return fu_input_stream_chunkify(stream, fu_digest_update_stream_cb, self, error);
+}
+
+/**
+ * fu_digest_get_value:
+ * @self: a #FuDigest
+ * @kind: a single #FuDigestKind, e.g. %FU_DIGEST_KIND_SUM16W_LE
+ *
+ * Gets the value of an arithmetic sum, XOR or CRC for all the data added so far.
+ *
+ * Returns: the value, or %G_MAXUINT32 if @kind was not requested
+ *
+ * Since: 2.1.2
+ **/
+guint32
+fu_digest_get_value(FuDigest *self, FuDigestKind kind)
+{
+	g_return_val_if_fail(FU_IS_DIGEST(self), G_MAXUINT32);
+	g_return_val_if_fail((self->kinds & kind) > 0, G_MAXUINT32);
+
+	switch (kind) {
+	case FU_DIGEST_KIND_SUM8:
+		return (guint8)fu_sum_lanes_to_sum(self->lanes);
+	case FU_DIGEST_KIND_SUM16:
+		return (guint16)fu_sum_lanes_to_sum(self->lanes);
+	case FU_DIGEST_KIND_SUM16W_LE:
+		return fu_sum_lanes_to_sum16w(self->lanes, G_LITTLE_ENDIAN);
+	case FU_DIGEST_KIND_SUM16W_BE:
+		return fu_sum_lanes_to_sum16w(self->lanes, G_BIG_ENDIAN);
+	case FU_DIGEST_KIND_SUM32:
+		return (guint32)fu_sum_lanes_to_sum(self->lanes);
+	case FU_DIGEST_KIND_SUM32W_LE:
+		return fu_sum_lanes_to_sum32w(self->lanes, G_LITTLE_ENDIAN);
+	case FU_DIGEST_KIND_SUM32W_BE:
+		return fu_sum_lanes_to_sum32w(self->lanes, G_BIG_ENDIAN);
+	case FU_DIGEST_KIND_XOR8:
+		return self->xor8;
+	case FU_DIGEST_KIND_CRC32:
+		return self->crc32;
+	default:
+		break;
+	}
+	g_critical("%s has no integer value", fu_digest_kind_to_string(kind));
+	return G_MAXUINT32;
+}
+
+/**
+ * fu_digest_get_string:
+ * @self: a #FuDigest
+ * @kind: a single #FuDigestKind, e.g. %FU_DIGEST_KIND_SHA256
+ *
+ * Gets the hexadecimal hash of all the data added so far.
+ *
+ * More data can be added after calling this function.
+ *
+ * Returns: (transfer full): the hash, or %NULL if @kind was not requested
+ *
+ * Since: 2.1.2
+ **/
+gchar *
+fu_digest_get_string(FuDigest *self, FuDigestKind kind)
+{
+	g_return_val_if_fail(FU_IS_DIGEST(self), NULL);
+	g_return_val_if_fail((self->kinds & kind) > 0, NULL);
+
+	for (guint i = 0; i < FU_DIGEST_CHECKSUM_TYPES; i++) {
+		if (fu_digest_checksum_idx_to_kind(i) == kind) {
+			g_autoptr(GChecksum) csum = g_checksum_copy(self->checksums[i]);
+			return g_strdup(g_checksum_get_string(csum));
+		}
+	}
+	g_critical("%s has no string value", fu_digest_kind_to_string(kind));
+	return NULL;
+}
+
+static void
+fu_digest_finalize(GObject *object)
+{
+	FuDigest *self = FU_DIGEST(object);
+	for (guint i = 0; i < FU_DIGEST_CHECKSUM_TYPES; i++) {
+		if (self->checksums[i] != NULL)
+			g_checksum_free(self->checksums[i]);
+	}
+	G_OBJECT_CLASS(fu_digest_parent_class)->finalize(object);
+}
+
+static void
+fu_digest_class_init(FuDigestClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_digest_finalize;
+}
+
+static void
+fu_digest_init(FuDigest *self)
+{
+}
+
+/**
+ * fu_digest_new:
+ * @kinds: a #FuDigestKind bitfield, e.g. %FU_DIGEST_KIND_SUM8 | %FU_DIGEST_KIND_SHA256
+ *
+ * Creates a new digest context that computes all of @kinds in a single pass of the data.
+ *
+ * Returns: (transfer full): a #FuDigest
+ *
+ * Since: 2.1.2
+ **/
+FuDigest *
+fu_digest_new(FuDigestKind kinds)
+{
+	FuDigest *self = g_object_new(FU_TYPE_DIGEST, NULL);
+	self->kinds = kinds;
+	for (guint i = 0; i < FU_DIGEST_CHECKSUM_TYPES; i++) {
+		if (kinds & fu_digest_checksum_idx_to_kind(i))
+			self->checksums[i] = g_checksum_new(fu_digest_checksum_idx_to_type(i));
+	}
+	return self;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#include "fu-digest-struct.h"
+
+#define FU_TYPE_DIGEST (fu_digest_get_type())
+
+G_DECLARE_FINAL_TYPE(FuDigest, fu_digest, FU, DIGEST, GObject)
+
+FuDigest *
+fu_digest_new(FuDigestKind kinds);
+FuDigestKind
+fu_digest_kind_from_checksum_type(GChecksumType checksum_type);
+FuDigestKind
+fu_digest_get_kinds(FuDigest *self) G_GNUC_NON_NULL(1);
+gsize
+fu_digest_get_size(FuDigest *self) G_GNUC_NON_NULL(1);
+void
+fu_digest_update(FuDigest *self, const guint8 *buf, gsize bufsz) G_GNUC_NON_NULL(1);
+void
+fu_digest_update_bytes(FuDigest *self, GBytes *blob) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_digest_update_stream(FuDigest *self, GInputStream *stream, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
+guint32
+fu_digest_get_value(FuDigest *self, FuDigestKind kind) G_GNUC_NON_NULL(1);
+gchar *
+fu_digest_get_string(FuDigest *self, FuDigestKind kind) G_GNUC_NON_NULL(1);
@@ -0,0 +1,20 @@
+// Copyright 2026 Richard Hughes <richard@hughsie.com>
+// SPDX-License-Identifier: LGPL-2.1-or-later
+
+#[derive(ToString, FromString)]
+enum FuDigestKind {
+    None = 0,
+    Sum8 = 1 << 0,
+    Sum16 = 1 << 1,
+    Sum16wLe = 1 << 2,
+    Sum16wBe = 1 << 3,
+    Sum32 = 1 << 4,
+    Sum32wLe = 1 << 5,
+    Sum32wBe = 1 << 6,
+    Xor8 = 1 << 7,
+    Crc32 = 1 << 8, // FuCrcKind::B32Standard
+    Sha1 = 1 << 9,
+    Sha256 = 1 << 10,
+    Sha384 = 1 << 11,
+    Sha512 = 1 << 12,
+}
@@ -78,15 +78,11 @@ fu_efi_section_parse_lzma_sections(FuEfiSection *self,
 				   FuFirmwareParseFlags flags,
 				   GError **error)
 {
-	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GBytes) blob_uncomp = NULL;
 	g_autoptr(GInputStream) stream_uncomp = NULL;
 
 	/* parse all sections */
-	blob = fu_input_stream_read_bytes(stream, 0, G_MAXSIZE, NULL, error);
-	if (blob == NULL)
-		return FALSE;
-	blob_uncomp = fu_lzma_decompress_bytes(blob, 128 * FU_MB, error);
+	blob_uncomp = fu_lzma_decompress_stream_to_bytes(stream, 128 * FU_MB, error);
 	if (blob_uncomp == NULL) {
 		g_prefix_error_literal(error, "failed to decompress: ");
 		return FALSE;
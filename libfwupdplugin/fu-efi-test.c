@@ -10,6 +10,7 @@
 
 #include "fu-context-private.h"
 #include "fu-efi-lz77-decompressor.h"
+#include "fu-efi-signature-private.h"
 #include "fu-efi-x509-signature-private.h"
 
 static void
@@ -142,6 +143,83 @@ fu_efi_signature_list_func(void)
 	g_assert_cmpint(fu_firmware_get_version_raw(FU_FIRMWARE(sig)), ==, 2024);
 }
 
+/* like fu_dbxtool_siglist_inclusive() */
+static gboolean
+fu_efi_signature_list_inclusive(FuFirmware *outer, FuFirmware *inner, gboolean use_index)
+{
+	g_autoptr(GPtrArray) sigs = fu_firmware_get_images(inner);
+	g_autoptr(GPtrArray) sigs_outer = fu_firmware_get_images(outer);
+
+	for (guint i = 0; i < sigs->len; i++) {
+		FuFirmware *sig = g_ptr_array_index(sigs, i);
+		gboolean found = FALSE;
+		g_autofree gchar *checksum = NULL;
+
+		checksum = fu_firmware_get_checksum(sig, G_CHECKSUM_SHA256, NULL);
+		if (checksum == NULL)
+			continue;
+		if (use_index) {
+			g_autoptr(FuFirmware) img =
+			    fu_firmware_get_image_by_checksum(outer, checksum, NULL);
+			found = img != NULL;
+		} else {
+			for (guint j = 0; j < sigs_outer->len && !found; j++) {
+				FuFirmware *sig_outer = g_ptr_array_index(sigs_outer, j);
+				g_autofree gchar *checksum_outer =
+				    fu_firmware_get_checksum(sig_outer, G_CHECKSUM_SHA256, NULL);
+				found = g_strcmp0(checksum_outer, checksum) == 0;
+			}
+		}
+		if (!found)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+fu_efi_signature_list_inclusive_func(void)
+{
+	g_autoptr(FuFirmware) dbx_system = fu_efi_signature_list_new();
+	g_autoptr(FuFirmware) dbx_update = fu_efi_signature_list_new();
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* the update has the same hashes as the system dbx, in reverse order */
+	for (guint i = 0; i < 2000; i++) {
+		gboolean ret;
+		guint8 buf[32] = {0x0};
+		g_autoptr(FuEfiSignature) sig = fu_efi_signature_new(FU_EFI_SIGNATURE_KIND_SHA256);
+		g_autoptr(FuEfiSignature) sig_update =
+		    fu_efi_signature_new(FU_EFI_SIGNATURE_KIND_SHA256);
+		g_autoptr(GBytes) blob = NULL;
+		g_autoptr(GBytes) blob_update = NULL;
+		g_autoptr(GError) error = NULL;
+
+		fu_memwrite_uint32(buf, i, G_LITTLE_ENDIAN);
+		blob = g_bytes_new(buf, sizeof(buf));
+		fu_firmware_set_bytes(FU_FIRMWARE(sig), blob);
+		ret = fu_firmware_add_image(dbx_system, FU_FIRMWARE(sig), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+
+		fu_memwrite_uint32(buf, 1999 - i, G_LITTLE_ENDIAN);
+		blob_update = g_bytes_new(buf, sizeof(buf));
+		fu_firmware_set_bytes(FU_FIRMWARE(sig_update), blob_update);
+		ret = fu_firmware_add_image(dbx_update, FU_FIRMWARE(sig_update), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+
+	g_timer_reset(timer);
+	g_assert_true(fu_efi_signature_list_inclusive(dbx_system, dbx_update, FALSE));
+	g_test_message("linear: %.1fms", g_timer_elapsed(timer, NULL) * 1000);
+	g_timer_reset(timer);
+	g_assert_true(fu_efi_signature_list_inclusive(dbx_system, dbx_update, TRUE));
+	g_test_message("indexed: %.1fms", g_timer_elapsed(timer, NULL) * 1000);
+	g_timer_reset(timer);
+	g_assert_true(fu_efi_signature_list_inclusive(dbx_system, dbx_update, TRUE));
+	g_test_message("indexed again: %.1fms", g_timer_elapsed(timer, NULL) * 1000);
+}
+
 static void
 fu_efi_lz77_decompressor_func(void)
 {
@@ -312,6 +390,10 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/efi/load-option/hive", fu_efi_load_option_hive_func);
 	g_test_add_func("/fwupd/efi/x509-signature", fu_efi_x509_signature_func);
 	g_test_add_func("/fwupd/efi/signature-list", fu_efi_signature_list_func);
+	if (g_test_perf()) {
+		g_test_add_func("/fwupd/efi/signature-list/inclusive",
+				fu_efi_signature_list_inclusive_func);
+	}
 	g_test_add_func("/fwupd/efi/variable-authentication2",
 			fu_efi_variable_authentication2_func);
 	g_test_add_func("/fwupd/efi/lz77/decompressor", fu_efi_lz77_decompressor_func);
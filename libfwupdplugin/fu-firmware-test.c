@@ -763,6 +763,275 @@ fu_firmware_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_firmware_checksums_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum_new = NULL;
+	g_autofree gchar *checksum_sha1 = NULL;
+	g_autofree gchar *checksum_sha256 = NULL;
+	g_autofree gchar *checksum_sha512 = NULL;
+	g_autofree gchar *str_sha1 = NULL;
+	g_autofree gchar *str_sha256 = NULL;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(FuFirmware) firmware_ihex = fu_ihex_firmware_new();
+	g_autoptr(GBytes) blob = g_bytes_new_static("hello world", 11);
+	g_autoptr(GBytes) blob_new = g_bytes_new_static("new", 3);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes(blob);
+
+	ret = fu_firmware_set_stream(firmware, stream, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* both hashes from one read */
+	ret = fu_firmware_ensure_checksums(firmware,
+					   FU_DIGEST_KIND_SHA1 | FU_DIGEST_KIND_SHA256,
+					   &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	checksum_sha1 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA1, &error);
+	g_assert_no_error(error);
+	str_sha1 = g_compute_checksum_for_bytes(G_CHECKSUM_SHA1, blob);
+	g_assert_cmpstr(checksum_sha1, ==, str_sha1);
+	checksum_sha256 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	str_sha256 = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob);
+	g_assert_cmpstr(checksum_sha256, ==, str_sha256);
+
+	/* not precomputed */
+	checksum_sha512 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA512, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(checksum_sha512);
+
+	/* cache is invalidated when the data changes */
+	fu_firmware_set_bytes(firmware, blob_new);
+	checksum_new = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(checksum_new, !=, checksum_sha256);
+
+	/* calculated from the written image, so cannot be cached */
+	ret = fu_firmware_ensure_checksums(firmware_ihex, FU_DIGEST_KIND_SHA256, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false(ret);
+}
+
+static void
+fu_firmware_checksums_stream_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum_sha1 = NULL;
+	g_autofree gchar *checksum_sha256 = NULL;
+	g_autofree gchar *str_sha256 = NULL;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(GBytes) blob = g_bytes_new_static("hello world", 11);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes(blob);
+
+	ret = fu_firmware_set_stream(firmware, stream, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* first verification reads the stream */
+	checksum_sha1 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(checksum_sha1);
+
+	/* the second does not, as the stream can no longer be read */
+	ret = g_input_stream_close(stream, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	checksum_sha256 = fu_firmware_get_checksum(firmware, G_CHECKSUM_SHA256, &error);
+	g_assert_no_error(error);
+	str_sha256 = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob);
+	g_assert_cmpstr(checksum_sha256, ==, str_sha256);
+}
+
+static void
+fu_firmware_image_index_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(FuFirmware) img_tmp = NULL;
+	g_autoptr(GBytes) blob_new = g_bytes_new_static("new", 3);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
+
+	/* similar to a dbx update */
+	for (guint i = 0; i < 400; i++) {
+		g_autofree gchar *id = g_strdup_printf("img%03u", i % 399);
+		g_autoptr(GBytes) blob = g_bytes_new(&i, sizeof(i));
+		g_autoptr(FuFirmware) img = fu_firmware_new_from_bytes(blob);
+		fu_firmware_set_id(img, id);
+		fu_firmware_set_idx(img, i);
+		ret = fu_firmware_add_image(firmware, img, &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+		g_ptr_array_add(checksums, g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob));
+	}
+	for (guint i = 0; i < checksums->len; i++) {
+		const gchar *checksum_tmp = g_ptr_array_index(checksums, i);
+		g_autoptr(FuFirmware) img = NULL;
+
+		img = fu_firmware_get_image_by_checksum(firmware, checksum_tmp, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(img);
+		g_assert_cmpint(fu_firmware_get_idx(img), ==, i);
+	}
+
+	/* duplicate IDs use the first image */
+	img_tmp = fu_firmware_get_image_by_id(firmware, "img000", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img_tmp);
+	g_assert_cmpint(fu_firmware_get_idx(img_tmp), ==, 0);
+	g_clear_object(&img_tmp);
+
+	/* changing the image data invalidates the checksum index */
+	img_tmp = fu_firmware_get_image_by_idx(firmware, 1, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img_tmp);
+	fu_firmware_set_bytes(img_tmp, blob_new);
+	fu_firmware_set_id(img_tmp, "changed");
+	g_clear_object(&img_tmp);
+	img_tmp =
+	    fu_firmware_get_image_by_checksum(firmware, g_ptr_array_index(checksums, 1), &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp);
+	g_clear_error(&error);
+	checksum = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_new);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img_tmp);
+	g_assert_cmpint(fu_firmware_get_idx(img_tmp), ==, 1);
+	g_clear_object(&img_tmp);
+
+	/* changing the image ID invalidates the ID index */
+	img_tmp = fu_firmware_get_image_by_id(firmware, "img001", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp);
+	g_clear_error(&error);
+	img_tmp = fu_firmware_get_image_by_id(firmware, "changed", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(img_tmp);
+	g_assert_cmpint(fu_firmware_get_idx(img_tmp), ==, 1);
+
+	/* removing the image invalidates both */
+	ret = fu_firmware_remove_image(firmware, img_tmp, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_clear_object(&img_tmp);
+	img_tmp = fu_firmware_get_image_by_id(firmware, "changed", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp);
+	g_clear_error(&error);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp);
+}
+
+static void
+fu_firmware_image_index_nested_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum_old = NULL;
+	g_autofree gchar *checksum_new = NULL;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(FuFirmware) img = fu_linear_firmware_new(FU_TYPE_FIRMWARE);
+	g_autoptr(FuFirmware) img_child = NULL;
+	g_autoptr(FuFirmware) img_tmp = NULL;
+	g_autoptr(GBytes) blob_old = g_bytes_new_static("old", 3);
+	g_autoptr(GBytes) blob_new = g_bytes_new_static("new", 3);
+	g_autoptr(GError) error = NULL;
+
+	/* the checksum of the image is calculated from the written child */
+	img_child = fu_firmware_new_from_bytes(blob_old);
+	ret = fu_firmware_add_image(img, img_child, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_add_image(firmware, img, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	checksum_old = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_old);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_old, &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp == img);
+	g_clear_object(&img_tmp);
+
+	/* changing the grandchild invalidates the checksum index */
+	fu_firmware_set_bytes(img_child, blob_new);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_old, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp);
+	g_clear_error(&error);
+	checksum_new = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_new);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_new, &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp == img);
+	g_clear_object(&img_tmp);
+
+	/* so does removing it */
+	ret = fu_firmware_remove_image(img, img_child, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_new, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(img_tmp);
+}
+
+static void
+fu_firmware_image_index_error_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *checksum_bar = NULL;
+	g_autofree gchar *checksum_foo = NULL;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new();
+	g_autoptr(FuFirmware) img_foo = fu_firmware_new();
+	g_autoptr(FuFirmware) img_empty = fu_firmware_new();
+	g_autoptr(FuFirmware) img_bar = fu_firmware_new();
+	g_autoptr(FuFirmware) img_tmp = NULL;
+	g_autoptr(GBytes) blob_foo = g_bytes_new_static("foo", 3);
+	g_autoptr(GBytes) blob_bar = g_bytes_new_static("bar", 3);
+	g_autoptr(GBytes) blob_baz = g_bytes_new_static("baz", 3);
+	g_autoptr(GError) error = NULL;
+
+	/* the middle image has no data, and so cannot be checksummed */
+	fu_firmware_set_bytes(img_foo, blob_foo);
+	fu_firmware_set_bytes(img_bar, blob_bar);
+	ret = fu_firmware_add_image(firmware, img_foo, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_add_image(firmware, img_empty, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	ret = fu_firmware_add_image(firmware, img_bar, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* images before the failure are still found */
+	checksum_foo = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_foo);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_foo, &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp == img_foo);
+	g_clear_object(&img_tmp);
+
+	/* the saved failure is returned every time */
+	checksum_bar = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, blob_bar);
+	for (guint i = 0; i < 2; i++) {
+		img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_bar, &error);
+		g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+		g_assert_nonnull(strstr(error->message, "no input data"));
+		g_assert_null(img_tmp);
+		g_clear_error(&error);
+	}
+
+	/* until the image is changed */
+	fu_firmware_set_bytes(img_empty, blob_baz);
+	img_tmp = fu_firmware_get_image_by_checksum(firmware, checksum_bar, &error);
+	g_assert_no_error(error);
+	g_assert_true(img_tmp == img_bar);
+}
+
 static void
 fu_firmware_convert_version_func(void)
 {
@@ -1119,6 +1388,11 @@ main(int argc, char **argv)
 	fu_context_add_firmware_gtypes(ctx);
 	g_test_add_func("/fwupd/firmware", fu_firmware_func);
 	g_test_add_func("/fwupd/firmware/common", fu_firmware_common_func);
+	g_test_add_func("/fwupd/firmware/image-index", fu_firmware_image_index_func);
+	g_test_add_func("/fwupd/firmware/image-index/nested", fu_firmware_image_index_nested_func);
+	g_test_add_func("/fwupd/firmware/image-index/error", fu_firmware_image_index_error_func);
+	g_test_add_func("/fwupd/firmware/checksums", fu_firmware_checksums_func);
+	g_test_add_func("/fwupd/firmware/checksums/stream", fu_firmware_checksums_stream_func);
 	g_test_add_func("/fwupd/firmware/convert-version", fu_firmware_convert_version_func);
 	g_test_add_func("/fwupd/firmware/builder-round-trip", fu_firmware_builder_round_trip_func);
 	g_test_add_func("/fwupd/firmware/csv", fu_firmware_csv_func);
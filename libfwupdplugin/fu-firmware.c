@@ -8,6 +8,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "fu-byte-array.h"
 #include "fu-bytes.h"
 #include "fu-chunk-private.h"
@@ -51,6 +53,10 @@ typedef struct {
 	GPtrArray *chunks;  /* nullable, element-type FuChunk */
 	GPtrArray *patches; /* nullable, element-type FuFirmwarePatch */
 	GPtrArray *magic;   /* nullable, element-type FuFirmwarePatch */
+	GHashTable *image_ids;		   /* nullable, element-type utf8 FuFirmware */
+	GHashTable *image_checksums;	   /* nullable, element-type GChecksumType GHashTable */
+	GHashTable *image_checksum_errors; /* nullable, element-type GChecksumType GError */
+	GHashTable *checksums;		   /* nullable, element-type GChecksumType utf8 */
 } FuFirmwarePrivate;
 
 static void
@@ -296,6 +302,33 @@ fu_firmware_set_filename(FuFirmware *self, const gchar *filename)
 	priv->filename = g_strdup(filename);
 }
 
+/* the lookup indexes of the parent are invalid when images are added, removed or changed */
+static void
+fu_firmware_invalidate_image_index(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_clear_pointer(&priv->image_ids, g_hash_table_unref);
+	g_clear_pointer(&priv->image_checksums, g_hash_table_unref);
+	g_clear_pointer(&priv->image_checksum_errors, g_hash_table_unref);
+}
+
+static void
+fu_firmware_invalidate_checksums(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	g_clear_pointer(&priv->checksums, g_hash_table_unref);
+}
+
+/* a change to any image can also change the ->write() output, and so the checksum, of every
+ * ancestor -- so the lookup indexes of the entire parent chain are invalid */
+static void
+fu_firmware_invalidate_parent_image_index(FuFirmware *self)
+{
+	for (FuFirmware *parent = fu_firmware_get_parent(self); parent != NULL;
+	     parent = fu_firmware_get_parent(parent))
+		fu_firmware_invalidate_image_index(parent);
+}
+
 /**
  * fu_firmware_set_id:
  * @self: a #FuPlugin
@@ -315,6 +348,7 @@ fu_firmware_set_id(FuFirmware *self, const gchar *id)
 
 	g_free(priv->id);
 	priv->id = g_strdup(id);
+	fu_firmware_invalidate_parent_image_index(self);
 }
 
 /**
@@ -586,6 +620,8 @@ fu_firmware_set_bytes(FuFirmware *self, GBytes *bytes)
 
 	/* the input stream is no longer valid */
 	g_clear_object(&priv->stream);
+	fu_firmware_invalidate_checksums(self);
+	fu_firmware_invalidate_parent_image_index(self);
 }
 
 /**
@@ -743,6 +779,8 @@ fu_firmware_set_stream(FuFirmware *self, GInputStream *stream, GError **error)
 		priv->streamsz = 0;
 	}
 	g_set_object(&priv->stream, stream);
+	fu_firmware_invalidate_checksums(self);
+	fu_firmware_invalidate_parent_image_index(self);
 	return TRUE;
 }
 
@@ -859,6 +897,50 @@ fu_firmware_add_magic(FuFirmware *self, const guint8 *buf, gsize bufsz, gsize of
 	g_ptr_array_add(priv->magic, g_steal_pointer(&patch));
 }
 
+static void
+fu_firmware_cache_checksum(FuFirmware *self, GChecksumType csum_kind, const gchar *checksum)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	if (priv->checksums == NULL)
+		priv->checksums =
+		    g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	g_hash_table_insert(priv->checksums, GINT_TO_POINTER(csum_kind), g_strdup(checksum));
+}
+
+/* the internal data can only be changed using ->set_bytes() or ->set_stream() */
+static gchar *
+fu_firmware_get_checksum_internal(FuFirmware *self, GChecksumType csum_kind, GError **error)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	const gchar *checksum_cached = NULL;
+	g_autofree gchar *checksum = NULL;
+
+	if (priv->checksums != NULL)
+		checksum_cached = g_hash_table_lookup(priv->checksums, GINT_TO_POINTER(csum_kind));
+	if (checksum_cached != NULL)
+		return g_strdup(checksum_cached);
+
+	/* a large stream is only read once for the SHA1 and SHA256 verification checksums */
+	if (priv->bytes == NULL &&
+	    (csum_kind == G_CHECKSUM_SHA1 || csum_kind == G_CHECKSUM_SHA256 ||
+	     csum_kind == G_CHECKSUM_SHA384 || csum_kind == G_CHECKSUM_SHA512)) {
+		if (!fu_firmware_ensure_checksums(self,
+						  fu_digest_kind_from_checksum_type(csum_kind) |
+						      FU_DIGEST_KIND_SHA1 | FU_DIGEST_KIND_SHA256,
+						  error))
+			return NULL;
+		return g_strdup(g_hash_table_lookup(priv->checksums, GINT_TO_POINTER(csum_kind)));
+	}
+	if (priv->bytes != NULL)
+		checksum = g_compute_checksum_for_bytes(csum_kind, priv->bytes);
+	else
+		checksum = fu_input_stream_compute_checksum(priv->stream, csum_kind, error);
+	if (checksum == NULL)
+		return NULL;
+	fu_firmware_cache_checksum(self, csum_kind, checksum);
+	return g_steal_pointer(&checksum);
+}
+
 /**
  * fu_firmware_get_checksum:
  * @self: a #FuPlugin
@@ -902,10 +984,8 @@ fu_firmware_get_checksum(FuFirmware *self, GChecksumType csum_kind, GError **err
 	}
 
 	/* internal data */
-	if (priv->bytes != NULL)
-		return g_compute_checksum_for_bytes(csum_kind, priv->bytes);
-	if (priv->stream != NULL)
-		return fu_input_stream_compute_checksum(priv->stream, csum_kind, error);
+	if (priv->bytes != NULL || priv->stream != NULL)
+		return fu_firmware_get_checksum_internal(self, csum_kind, error);
 
 	/* nothing to do */
 	g_set_error_literal(error,
@@ -915,6 +995,93 @@ fu_firmware_get_checksum(FuFirmware *self, GChecksumType csum_kind, GError **err
 	return NULL;
 }
 
+/**
+ * fu_firmware_ensure_checksums:
+ * @self: a #FuFirmware
+ * @kinds: a #FuDigestKind bitfield, e.g. %FU_DIGEST_KIND_SHA1 | %FU_DIGEST_KIND_SHA256
+ * @error: (nullable): optional return location for an error
+ *
+ * Computes all the requested cryptographic hashes of the payload data in a single pass, so that
+ * calling fu_firmware_get_checksum() for each type only reads the data once.
+ *
+ * Only the SHA digest kinds are used. If the subclass provides ->get_checksum() then the
+ * cached values are only used when that returns %FWUPD_ERROR_NOT_SUPPORTED.
+ *
+ * Checksums calculated from the written image cannot be cached, and so %FWUPD_ERROR_NOT_SUPPORTED
+ * is returned if the subclass provides ->write().
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 2.1.2
+ **/
+gboolean
+fu_firmware_ensure_checksums(FuFirmware *self, FuDigestKind kinds, GError **error)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS(self);
+	FuDigestKind kinds_missing = FU_DIGEST_KIND_NONE;
+	GChecksumType csum_kinds[] = {
+	    G_CHECKSUM_SHA1,
+	    G_CHECKSUM_SHA256,
+	    G_CHECKSUM_SHA384,
+	    G_CHECKSUM_SHA512,
+	};
+	g_autoptr(FuDigest) digest = NULL;
+
+	g_return_val_if_fail(FU_IS_FIRMWARE(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* not using the internal data */
+	if (klass->write != NULL) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "%s checksums are calculated from the written image",
+			    G_OBJECT_TYPE_NAME(self));
+		return FALSE;
+	}
+	if (priv->bytes == NULL && priv->stream == NULL) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_FOUND,
+				    "no input data, as no stream or bytes");
+		return FALSE;
+	}
+
+	/* already cached */
+	for (guint i = 0; i < G_N_ELEMENTS(csum_kinds); i++) {
+		FuDigestKind kind = fu_digest_kind_from_checksum_type(csum_kinds[i]);
+		if ((kinds & kind) == 0)
+			continue;
+		if (priv->checksums != NULL &&
+		    g_hash_table_contains(priv->checksums, GINT_TO_POINTER(csum_kinds[i])))
+			continue;
+		kinds_missing |= kind;
+	}
+	if (kinds_missing == FU_DIGEST_KIND_NONE)
+		return TRUE;
+
+	/* read the data once */
+	digest = fu_digest_new(kinds_missing);
+	if (priv->bytes != NULL) {
+		fu_digest_update_bytes(digest, priv->bytes);
+	} else {
+		if (!fu_digest_update_stream(digest, priv->stream, error))
+			return FALSE;
+	}
+	for (guint i = 0; i < G_N_ELEMENTS(csum_kinds); i++) {
+		FuDigestKind kind = fu_digest_kind_from_checksum_type(csum_kinds[i]);
+		g_autofree gchar *checksum = NULL;
+		if ((kinds_missing & kind) == 0)
+			continue;
+		checksum = fu_digest_get_string(digest, kind);
+		fu_firmware_cache_checksum(self, csum_kinds[i], checksum);
+	}
+
+	/* success */
+	return TRUE;
+}
+
 /**
  * fu_firmware_tokenize:
  * @self: a #FuFirmware
@@ -1196,8 +1363,10 @@ fu_firmware_parse_stream(FuFirmware *self,
 		}
 		fu_firmware_set_bytes(self, blob);
 	}
-	if (flags & FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM)
+	if (flags & FU_FIRMWARE_PARSE_FLAG_CACHE_STREAM) {
 		g_set_object(&priv->stream, partial_stream);
+		fu_firmware_invalidate_checksums(self);
+	}
 
 	/* optional */
 	if (klass->tokenize != NULL) {
@@ -1694,6 +1863,7 @@ fu_firmware_add_patch(FuFirmware *self, gsize offset, GBytes *blob)
 	ptch->offset = offset;
 	ptch->blob = g_bytes_ref(blob);
 	g_ptr_array_add(priv->patches, ptch);
+	fu_firmware_invalidate_parent_image_index(self);
 }
 
 /**
@@ -1966,6 +2136,8 @@ fu_firmware_add_image(FuFirmware *self, FuFirmware *img, GError **error)
 	}
 
 	g_ptr_array_add(priv->images, g_object_ref(img));
+	fu_firmware_invalidate_image_index(self);
+	fu_firmware_invalidate_parent_image_index(self);
 
 	/* set the other way around */
 	fu_firmware_set_parent(img, self);
@@ -2031,8 +2203,11 @@ fu_firmware_remove_image(FuFirmware *self, FuFirmware *img, GError **error)
 	g_return_val_if_fail(FU_IS_FIRMWARE(img), FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	if (g_ptr_array_remove(priv->images, img))
+	if (g_ptr_array_remove(priv->images, img)) {
+		fu_firmware_invalidate_image_index(self);
+		fu_firmware_invalidate_parent_image_index(self);
 		return TRUE;
+	}
 
 	/* did not exist */
 	g_set_error(error,
@@ -2068,6 +2243,8 @@ fu_firmware_remove_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
 	if (img == NULL)
 		return FALSE;
 	g_ptr_array_remove(priv->images, img);
+	fu_firmware_invalidate_image_index(self);
+	fu_firmware_invalidate_parent_image_index(self);
 	return TRUE;
 }
 
@@ -2096,6 +2273,8 @@ fu_firmware_remove_image_by_id(FuFirmware *self, const gchar *id, GError **error
 	if (img == NULL)
 		return FALSE;
 	g_ptr_array_remove(priv->images, img);
+	fu_firmware_invalidate_image_index(self);
+	fu_firmware_invalidate_parent_image_index(self);
 	return TRUE;
 }
 
@@ -2125,6 +2304,25 @@ fu_firmware_get_images(FuFirmware *self)
 	return g_steal_pointer(&imgs);
 }
 
+/* only the first image is used if there are duplicate IDs */
+static void
+fu_firmware_ensure_image_ids(FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+
+	if (priv->image_ids != NULL)
+		return;
+	priv->image_ids =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmware *img = g_ptr_array_index(priv->images, i);
+		const gchar *id = fu_firmware_get_id(img);
+		if (id == NULL || g_hash_table_contains(priv->image_ids, id))
+			continue;
+		g_hash_table_insert(priv->image_ids, g_strdup(id), g_object_ref(img));
+	}
+}
+
 /**
  * fu_firmware_get_image_by_id:
  * @self: a #FuPlugin
@@ -2156,8 +2354,14 @@ fu_firmware_get_image_by_id(FuFirmware *self, const gchar *id, GError **error)
 		return NULL;
 	}
 
-	/* non-NULL */
-	if (id != NULL) {
+	/* exact match, using an index that is built on first use */
+	if (id != NULL && strpbrk(id, "*?|") == NULL) {
+		FuFirmware *img;
+		fu_firmware_ensure_image_ids(self);
+		img = g_hash_table_lookup(priv->image_ids, id);
+		if (img != NULL)
+			return g_object_ref(img);
+	} else if (id != NULL) {
 		g_auto(GStrv) split = g_strsplit(id, "|", 0);
 		for (guint i = 0; i < priv->images->len; i++) {
 			FuFirmware *img = g_ptr_array_index(priv->images, i);
@@ -2266,6 +2470,55 @@ fu_firmware_get_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
 	return NULL;
 }
 
+/* returns a hash table of checksum to image, which only has the images before the first that
+ * cannot be checksummed -- the failure is saved in ->image_checksum_errors to be reused */
+static GHashTable *
+fu_firmware_ensure_image_checksums(FuFirmware *self, GChecksumType csum_kind)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE(self);
+	GHashTable *checksums;
+
+	if (priv->image_checksums == NULL) {
+		priv->image_checksums = g_hash_table_new_full(g_direct_hash,
+							      g_direct_equal,
+							      NULL,
+							      (GDestroyNotify)g_hash_table_unref);
+	}
+	checksums = g_hash_table_lookup(priv->image_checksums, GINT_TO_POINTER(csum_kind));
+	if (checksums != NULL)
+		return checksums;
+
+	checksums =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_object_unref);
+	g_hash_table_insert(priv->image_checksums, GINT_TO_POINTER(csum_kind), checksums);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmware *img = g_ptr_array_index(priv->images, i);
+		g_autofree gchar *checksum = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		/* if this expensive then the subclassed FuFirmware can
+		 * cache the result as required */
+		checksum = fu_firmware_get_checksum(img, csum_kind, &error_local);
+		if (checksum == NULL) {
+			if (priv->image_checksum_errors == NULL) {
+				priv->image_checksum_errors =
+				    g_hash_table_new_full(g_direct_hash,
+							  g_direct_equal,
+							  NULL,
+							  (GDestroyNotify)g_error_free);
+			}
+			g_hash_table_insert(priv->image_checksum_errors,
+					    GINT_TO_POINTER(csum_kind),
+					    g_steal_pointer(&error_local));
+			break;
+		}
+		if (g_hash_table_contains(checksums, checksum))
+			continue;
+		g_hash_table_insert(checksums, g_steal_pointer(&checksum), g_object_ref(img));
+	}
+	return checksums;
+}
+
 /**
  * fu_firmware_get_image_by_checksum:
  * @self: a #FuPlugin
@@ -2275,6 +2528,10 @@ fu_firmware_get_image_by_idx(FuFirmware *self, guint64 idx, GError **error)
  * Gets the firmware image using the image checksum. The checksum type is guessed
  * based on the length of the input string.
  *
+ * The image checksums are only calculated on the first call, and are recalculated if images
+ * are added or removed, or if the ID, data or patches of an image or any of its children are
+ * changed.
+ *
  * Returns: (transfer full): a #FuFirmware, or %NULL if the image is not found
  *
  * Since: 1.5.5
@@ -2284,23 +2541,27 @@ fu_firmware_get_image_by_checksum(FuFirmware *self, const gchar *checksum, GErro
 {
 	FuFirmwarePrivate *priv = GET_PRIVATE(self);
 	GChecksumType csum_kind;
+	GHashTable *checksums;
+	FuFirmware *img;
 
 	g_return_val_if_fail(FU_IS_FIRMWARE(self), NULL);
 	g_return_val_if_fail(checksum != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
 	csum_kind = fwupd_checksum_guess_kind(checksum);
-	for (guint i = 0; i < priv->images->len; i++) {
-		FuFirmware *img = g_ptr_array_index(priv->images, i);
-		g_autofree gchar *checksum_tmp = NULL;
-
-		/* if this expensive then the subclassed FuFirmware can
-		 * cache the result as required */
-		checksum_tmp = fu_firmware_get_checksum(img, csum_kind, error);
-		if (checksum_tmp == NULL)
+	checksums = fu_firmware_ensure_image_checksums(self, csum_kind);
+	img = g_hash_table_lookup(checksums, checksum);
+	if (img != NULL)
+		return g_object_ref(img);
+
+	/* a later image could not be checksummed */
+	if (priv->image_checksum_errors != NULL) {
+		const GError *error_cached =
+		    g_hash_table_lookup(priv->image_checksum_errors, GINT_TO_POINTER(csum_kind));
+		if (error_cached != NULL) {
+			g_propagate_error(error, g_error_copy(error_cached));
 			return NULL;
-		if (g_strcmp0(checksum_tmp, checksum) == 0)
-			return g_object_ref(img);
+		}
 	}
 	g_set_error(error,
 		    FWUPD_ERROR,
@@ -2707,6 +2968,14 @@ fu_firmware_finalize(GObject *object)
 		g_ptr_array_unref(priv->patches);
 	if (priv->magic != NULL)
 		g_ptr_array_unref(priv->magic);
+	if (priv->image_ids != NULL)
+		g_hash_table_unref(priv->image_ids);
+	if (priv->image_checksums != NULL)
+		g_hash_table_unref(priv->image_checksums);
+	if (priv->image_checksum_errors != NULL)
+		g_hash_table_unref(priv->image_checksum_errors);
+	if (priv->checksums != NULL)
+		g_hash_table_unref(priv->checksums);
 	if (priv->parent != NULL)
 		g_object_remove_weak_pointer(G_OBJECT(priv->parent), (gpointer *)&priv->parent);
 	g_ptr_array_unref(priv->images);
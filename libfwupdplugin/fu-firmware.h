@@ -10,6 +10,7 @@
 #include <xmlb.h>
 
 #include "fu-chunk.h"
+#include "fu-digest.h"
 #include "fu-firmware-struct.h"
 
 #define FU_TYPE_FIRMWARE (fu_firmware_get_type())
@@ -225,6 +226,9 @@ gchar *
 fu_firmware_get_checksum(FuFirmware *self, GChecksumType csum_kind, GError **error)
     G_GNUC_NON_NULL(1);
 gboolean
+fu_firmware_ensure_checksums(FuFirmware *self, FuDigestKind kinds, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+gboolean
 fu_firmware_check_compatible(FuFirmware *self,
 			     FuFirmware *other,
 			     FuFirmwareParseFlags flags,
@@ -52,6 +52,105 @@ fu_input_stream_find_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_input_stream_find_boundary_func(void)
+{
+	const gchar *needle = "Firmware";
+	gboolean ret;
+	gsize bufsz = 0x30000;
+	gsize offset = 0;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* spans the first block boundary */
+	memcpy(buf + 0x10000 - 3, needle, strlen(needle)); /* nocheck:blocked */
+	stream = g_memory_input_stream_new_from_data(buf, bufsz, NULL);
+	ret = fu_input_stream_find(stream, (const guint8 *)needle, strlen(needle), 0x0, &offset, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, 0x10000 - 3);
+
+	/* right at the end */
+	memcpy(buf + bufsz - strlen(needle), needle, strlen(needle)); /* nocheck:blocked */
+	ret = fu_input_stream_find(stream,
+				   (const guint8 *)needle,
+				   strlen(needle),
+				   0x10000,
+				   &offset,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, bufsz - strlen(needle));
+}
+
+static void
+fu_input_stream_find_any_func(void)
+{
+	const gchar *haystack = "I write free software. Firmware troublemaker, writing Firmware.";
+	gboolean ret;
+	gsize offset = 0;
+	guint idx = G_MAXUINT;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GPtrArray) needles = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
+
+	stream =
+	    g_memory_input_stream_new_from_data((const guint8 *)haystack, strlen(haystack), NULL);
+	g_ptr_array_add(needles, g_bytes_new_static("writing", 7));
+	g_ptr_array_add(needles, g_bytes_new_static("Firmware", 8));
+	g_ptr_array_add(needles, g_bytes_new_static("Firm", 4));
+	ret = fu_input_stream_find_any(stream, needles, 0x0, &idx, &offset, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(idx, ==, 1);
+	g_assert_cmpint(offset, ==, 23);
+
+	/* find later match */
+	ret = fu_input_stream_find_any(stream, needles, 24, &idx, &offset, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(idx, ==, 0);
+	g_assert_cmpint(offset, ==, 46);
+
+	/* no match */
+	ret = fu_input_stream_find_any(stream, needles, 55, &idx, &offset, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false(ret);
+}
+
+static void
+fu_input_stream_find_performance_func(void)
+{
+	const gchar *needle = "Firmware";
+	gboolean ret;
+	gsize bufsz = 0x1000000;
+	gsize offset = 0;
+	g_autofree guint8 *buf = g_malloc0(bufsz);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* worst case: needle right at the end */
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8)(i * 7);
+	memcpy(buf + bufsz - strlen(needle), needle, strlen(needle)); /* nocheck:blocked */
+
+	ret = fu_memmem_safe(buf, bufsz, (const guint8 *)needle, strlen(needle), &offset, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, bufsz - strlen(needle));
+	g_debug("memmem=%.1fMB/s", 16.f / g_timer_elapsed(timer, NULL));
+
+	g_timer_reset(timer);
+	stream = g_memory_input_stream_new_from_data(buf, bufsz, NULL);
+	ret = fu_input_stream_find(stream, (const guint8 *)needle, strlen(needle), 0x0, &offset, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(offset, ==, bufsz - strlen(needle));
+	g_debug("stream=%.1fMB/s", 16.f / g_timer_elapsed(timer, NULL));
+}
+
 static void
 fu_input_stream_sum_overflow_func(void)
 {
@@ -115,6 +214,38 @@ fu_input_stream_chunkify_func(void)
 	g_assert_cmpint(crc32, ==, fu_crc32(FU_CRC_KIND_B32_STANDARD, buf->data, buf->len));
 }
 
+static void
+fu_input_stream_find_crc_kinds_func(void)
+{
+	guint32 crc32;
+	g_autoptr(GByteArray) buf = g_byte_array_new();
+	g_autoptr(GArray) kinds = NULL;
+	g_autoptr(GArray) kinds2 = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	for (guint i = 0; i < 0x80000; i++)
+		fu_byte_array_append_uint8(buf, i);
+	blob = g_bytes_new(buf->data, buf->len);
+	stream = g_memory_input_stream_new_from_bytes(blob);
+
+	/* every kind is computed in one pass */
+	crc32 = fu_crc32(FU_CRC_KIND_B32_BZIP2, buf->data, buf->len);
+	kinds = fu_input_stream_find_crc_kinds(stream, crc32, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(kinds);
+	g_assert_cmpint(kinds->len, ==, 1);
+	g_assert_cmpint(g_array_index(kinds, FuCrcKind, 0), ==, FU_CRC_KIND_B32_BZIP2);
+
+	/* same as the buffer version */
+	kinds2 = fu_crc_find_kinds(buf->data, buf->len, crc32, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(kinds2);
+	g_assert_cmpint(kinds2->len, ==, 1);
+	g_assert_cmpint(g_array_index(kinds2, FuCrcKind, 0), ==, FU_CRC_KIND_B32_BZIP2);
+}
+
 static void
 fu_input_stream_func(void)
 {
@@ -198,6 +329,13 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/input-stream", fu_input_stream_func);
 	g_test_add_func("/fwupd/input-stream/sum-overflow", fu_input_stream_sum_overflow_func);
 	g_test_add_func("/fwupd/input-stream/chunkify", fu_input_stream_chunkify_func);
+	g_test_add_func("/fwupd/input-stream/find-crc-kinds", fu_input_stream_find_crc_kinds_func);
 	g_test_add_func("/fwupd/input-stream/find", fu_input_stream_find_func);
+	g_test_add_func("/fwupd/input-stream/find-boundary", fu_input_stream_find_boundary_func);
+	g_test_add_func("/fwupd/input-stream/find-any", fu_input_stream_find_any_func);
+	if (g_test_slow()) {
+		g_test_add_func("/fwupd/input-stream/find/performance",
+				fu_input_stream_find_performance_func);
+	}
 	return g_test_run();
 }
@@ -8,10 +8,11 @@
 
 #include "config.h"
 
-#include "fu-chunk-array.h"
 #include "fu-crc-private.h"
 #include "fu-input-stream.h"
+#include "fu-mapped-input-stream-private.h"
 #include "fu-mem-private.h"
+#include "fu-partial-input-stream-private.h"
 #include "fu-sum.h"
 
 /**
@@ -34,6 +35,17 @@ fu_input_stream_from_path(const gchar *path, GError **error)
 	g_return_val_if_fail(path != NULL, NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
+	/* try as a mapped file so that reads do not need a syscall */
+	if (g_file_test(path, G_FILE_TEST_IS_REGULAR)) {
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GInputStream) stream_mapped = NULL;
+
+		stream_mapped = fu_mapped_input_stream_new(path, &error_local);
+		if (stream_mapped != NULL)
+			return g_steal_pointer(&stream_mapped);
+		g_debug("failed to map %s, so reading instead: %s", path, error_local->message);
+	}
+
 	file = g_file_new_for_path(path);
 	stream = g_file_read(file, NULL, error);
 	if (stream == NULL) {
@@ -43,6 +55,32 @@ fu_input_stream_from_path(const gchar *path, GError **error)
 	return G_INPUT_STREAM(g_steal_pointer(&stream));
 }
 
+/*
+ * returns the memory backing the stream if it is a mapped file or a slice of one, which is only
+ * valid for the lifetime of @stream
+ */
+static const guint8 *
+fu_input_stream_get_mapped_data(GInputStream *stream, gsize *bufsz)
+{
+	if (g_input_stream_is_closed(stream))
+		return NULL;
+	if (FU_IS_MAPPED_INPUT_STREAM(stream)) {
+		GBytes *blob = fu_mapped_input_stream_get_bytes(FU_MAPPED_INPUT_STREAM(stream));
+		return g_bytes_get_data(blob, bufsz);
+	}
+	if (FU_IS_PARTIAL_INPUT_STREAM(stream)) {
+		FuPartialInputStream *partial_stream = FU_PARTIAL_INPUT_STREAM(stream);
+		GInputStream *base_stream = fu_partial_input_stream_get_base_stream(partial_stream);
+		const guint8 *buf = fu_input_stream_get_mapped_data(base_stream, NULL);
+		if (buf == NULL)
+			return NULL;
+		if (bufsz != NULL)
+			*bufsz = fu_partial_input_stream_get_size(partial_stream);
+		return buf + fu_partial_input_stream_get_offset(partial_stream);
+	}
+	return NULL;
+}
+
 /**
  * fu_input_stream_read_safe:
  * @stream: a #GInputStream
@@ -69,6 +107,8 @@ fu_input_stream_read_safe(GInputStream *stream,
 			  GError **error)
 {
 	gssize rc;
+	gsize bufsz_mapped = 0;
+	const guint8 *buf_mapped;
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
 	g_return_val_if_fail(buf != NULL, FALSE);
@@ -76,6 +116,25 @@ fu_input_stream_read_safe(GInputStream *stream,
 
 	if (!fu_memchk_write(bufsz, offset, count, error))
 		return FALSE;
+
+	/* copy directly from the mapping, only moving the stream position */
+	buf_mapped = fu_input_stream_get_mapped_data(stream, &bufsz_mapped);
+	if (buf_mapped != NULL) {
+		gsize count_mapped =
+		    seek_set < bufsz_mapped ? MIN(count, bufsz_mapped - seek_set) : 0;
+		if (count_mapped != count) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_READ,
+				    "requested 0x%x and got 0x%x",
+				    (guint)count,
+				    (guint)count_mapped);
+			return FALSE;
+		}
+		memcpy(buf + offset, buf_mapped + seek_set, count); /* nocheck:blocked */
+		return g_seekable_seek(G_SEEKABLE(stream), seek_set + count, G_SEEK_SET, NULL, error);
+	}
+
 	if (!g_seekable_seek(G_SEEKABLE(stream), seek_set, G_SEEK_SET, NULL, error)) {
 		g_prefix_error(error, "seek to 0x%x: ", (guint)seek_set);
 		return FALSE;
@@ -287,6 +346,30 @@ fu_input_stream_read_byte_array(GInputStream *stream,
 		return NULL;
 	}
 
+	/* copy directly from the mapping, only moving the stream position */
+	if (progress == NULL) {
+		gsize bufsz_mapped = 0;
+		const guint8 *buf_mapped = fu_input_stream_get_mapped_data(stream, &bufsz_mapped);
+		if (buf_mapped != NULL) {
+			if (offset >= bufsz_mapped) {
+				g_set_error_literal(error,
+						    FWUPD_ERROR,
+						    FWUPD_ERROR_INVALID_FILE,
+						    "no data could be read");
+				return NULL;
+			}
+			count = MIN(count, bufsz_mapped - offset);
+			g_byte_array_append(buf, buf_mapped + offset, count);
+			if (!g_seekable_seek(G_SEEKABLE(stream),
+					     offset + count,
+					     G_SEEK_SET,
+					     NULL,
+					     error))
+				return NULL;
+			return g_steal_pointer(&buf);
+		}
+	}
+
 	/* seek back to start */
 	if (G_IS_SEEKABLE(stream) && g_seekable_can_seek(G_SEEKABLE(stream))) {
 		if (!g_seekable_seek(G_SEEKABLE(stream), offset, G_SEEK_SET, NULL, error))
@@ -356,10 +439,33 @@ fu_input_stream_read_bytes(GInputStream *stream,
 			   FuProgress *progress,
 			   GError **error)
 {
+	gsize bufsz_mapped = 0;
+	const guint8 *buf_mapped;
 	g_autoptr(GByteArray) buf = NULL;
+
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 	g_return_val_if_fail(progress == NULL || FU_IS_PROGRESS(progress), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* borrow the mapping without copying, keeping the stream alive */
+	buf_mapped = fu_input_stream_get_mapped_data(stream, &bufsz_mapped);
+	if (buf_mapped != NULL && count > 0) {
+		if (offset >= bufsz_mapped) {
+			g_set_error_literal(error,
+					    FWUPD_ERROR,
+					    FWUPD_ERROR_INVALID_FILE,
+					    "no data could be read");
+			return NULL;
+		}
+		count = MIN(count, bufsz_mapped - offset);
+		if (!g_seekable_seek(G_SEEKABLE(stream), offset + count, G_SEEK_SET, NULL, error))
+			return NULL;
+		return g_bytes_new_with_free_func(buf_mapped + offset,
+						  count,
+						  (GDestroyNotify)g_object_unref,
+						  g_object_ref(stream));
+	}
+
 	buf = fu_input_stream_read_byte_array(stream, offset, count, progress, error);
 	if (buf == NULL)
 		return NULL;
@@ -683,6 +789,46 @@ fu_input_stream_compute_crc16(GInputStream *stream, FuCrcKind kind, guint16 *crc
 	return TRUE;
 }
 
+static gboolean
+fu_input_stream_find_crc_kinds_cb(const guint8 *buf,
+				  gsize bufsz,
+				  gpointer user_data,
+				  GError **error)
+{
+	FuCrcFindHelper *helper = (FuCrcFindHelper *)user_data;
+	fu_crc_find_helper_step(helper, buf, bufsz);
+	return TRUE;
+}
+
+/**
+ * fu_input_stream_find_crc_kinds:
+ * @stream: a #GInputStream
+ * @crc_target: "correct" CRC value
+ * @error: (nullable): optional return location for an error
+ *
+ * Returns all the cyclic redundancy kinds that match the stream and target CRC, without loading
+ * the entire stream into a buffer.
+ *
+ * Every candidate kind is computed in a single pass over @stream.
+ *
+ * Returns: (transfer full) (element-type FuCrcKind): kinds, or %NULL if none matched
+ *
+ * Since: 2.1.2
+ **/
+GArray *
+fu_input_stream_find_crc_kinds(GInputStream *stream, guint32 crc_target, GError **error)
+{
+	FuCrcFindHelper helper = {0};
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	fu_crc_find_helper_init(&helper, crc_target);
+	if (!fu_input_stream_chunkify(stream, fu_input_stream_find_crc_kinds_cb, &helper, error))
+		return NULL;
+	return fu_crc_find_helper_done(&helper, error);
+}
+
 /**
  * fu_input_stream_chunkify:
  * @stream: a #GInputStream
@@ -702,30 +848,138 @@ fu_input_stream_chunkify(GInputStream *stream,
 			 gpointer user_data,
 			 GError **error)
 {
-	g_autoptr(FuChunkArray) chunks = NULL;
+	gsize bufsz_mapped = 0;
+	gsize streamsz = 0;
+	const guint8 *buf_mapped;
+	g_autofree guint8 *buf = NULL;
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
 	g_return_val_if_fail(func_cb != NULL, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	chunks = fu_chunk_array_new_from_stream(stream,
-						FU_CHUNK_ADDR_OFFSET_NONE,
-						FU_CHUNK_PAGESZ_NONE,
-						0x8000,
-						error);
-	if (chunks == NULL)
+	/* use the mapping directly */
+	buf_mapped = fu_input_stream_get_mapped_data(stream, &bufsz_mapped);
+	if (buf_mapped != NULL) {
+		for (gsize offset = 0; offset < bufsz_mapped; offset += 0x8000) {
+			gsize bufsz = MIN(bufsz_mapped - offset, 0x8000);
+			if (!func_cb(buf_mapped + offset, bufsz, user_data, error))
+				return FALSE;
+		}
+		return TRUE;
+	}
+
+	/* each block is only used once, so read in order into the same buffer */
+	if (!fu_input_stream_size(stream, &streamsz, error))
 		return FALSE;
-	for (gsize i = 0; i < fu_chunk_array_length(chunks); i++) {
-		g_autoptr(FuChunk) chk = NULL;
-		chk = fu_chunk_array_index(chunks, i, error);
-		if (chk == NULL)
+	buf = g_malloc0(MIN(streamsz, 0x8000));
+	for (gsize offset = 0; offset < streamsz; offset += 0x8000) {
+		gsize bufsz = MIN(streamsz - offset, 0x8000);
+		if (!fu_input_stream_read_safe(stream, buf, bufsz, 0x0, offset, bufsz, error))
 			return FALSE;
-		if (!func_cb(fu_chunk_get_data(chk), fu_chunk_get_data_sz(chk), user_data, error))
+		if (!func_cb(buf, bufsz, user_data, error))
 			return FALSE;
 	}
 	return TRUE;
 }
 
+typedef gboolean (*FuInputStreamFindFunc)(const guint8 *buf,
+					   gsize bufsz,
+					   gsize limit,
+					   gsize *offset,
+					   gpointer user_data);
+
+/*
+ * calls @func_cb on a window that also keeps the last @overlap bytes of the previous block, so
+ * that a match can span the block boundary -- matches starting at or after @limit are searched
+ * again in the next window, unless at the end of the stream
+ */
+static gboolean
+fu_input_stream_find_internal(GInputStream *stream,
+			      gsize offset,
+			      gsize overlap,
+			      FuInputStreamFindFunc func_cb,
+			      gpointer user_data,
+			      gsize *offset_found,
+			      GError **error)
+{
+	const gsize blocksz = 0x10000;
+	gsize bufsz_mapped = 0;
+	gsize buf_len = 0;
+	gsize buf_offset = offset;
+	const guint8 *buf_mapped;
+	g_autofree guint8 *buf = NULL;
+
+	/* search the mapping directly */
+	buf_mapped = fu_input_stream_get_mapped_data(stream, &bufsz_mapped);
+	if (buf_mapped != NULL) {
+		gsize offset_tmp = 0;
+		if (offset >= bufsz_mapped)
+			return FALSE;
+		if (!func_cb(buf_mapped + offset,
+			     bufsz_mapped - offset,
+			     bufsz_mapped - offset,
+			     &offset_tmp,
+			     user_data))
+			return FALSE;
+		if (offset_found != NULL)
+			*offset_found = offset + offset_tmp;
+		return TRUE;
+	}
+
+	if (!g_seekable_seek(G_SEEKABLE(stream), offset, G_SEEK_SET, NULL, error)) {
+		g_prefix_error(error, "seek to 0x%x: ", (guint)offset);
+		return FALSE;
+	}
+	buf = g_malloc(overlap + blocksz);
+	while (TRUE) {
+		gboolean eof;
+		gsize limit;
+		gsize offset_tmp = 0;
+		gssize rc;
+
+		/* read the next block after the overlap */
+		rc = g_input_stream_read(stream, buf + buf_len, blocksz, NULL, error);
+		if (rc < 0) {
+			g_prefix_error(error, "failed read at 0x%x: ", (guint)(buf_offset + buf_len));
+			return FALSE;
+		}
+		buf_len += rc;
+		eof = rc == 0;
+		limit = eof ? buf_len : buf_len - MIN(buf_len, overlap);
+		if (limit > 0 && func_cb(buf, buf_len, limit, &offset_tmp, user_data)) {
+			if (offset_found != NULL)
+				*offset_found = buf_offset + offset_tmp;
+			return TRUE;
+		}
+		if (eof)
+			break;
+
+		/* only move the overlap, not the whole block */
+		if (limit > 0) {
+			memmove(buf, buf + limit, buf_len - limit); /* nocheck:blocked */
+			buf_offset += limit;
+			buf_len -= limit;
+		}
+	}
+	return FALSE;
+}
+
+typedef struct {
+	const guint8 *buf;
+	gsize bufsz;
+} FuInputStreamFindHelper;
+
+static gboolean
+fu_input_stream_find_cb(const guint8 *buf,
+			gsize bufsz,
+			gsize limit,
+			gsize *offset,
+			gpointer user_data)
+{
+	FuInputStreamFindHelper *helper = (FuInputStreamFindHelper *)user_data;
+	return fu_memmem_safe(buf, bufsz, helper->buf, helper->bufsz, offset, NULL);
+}
+
 /**
  * fu_input_stream_find:
  * @stream: a #GInputStream
@@ -749,55 +1003,142 @@ fu_input_stream_find(GInputStream *stream,
 		     gsize *offset_found,
 		     GError **error)
 {
-	g_autoptr(GByteArray) buf_acc = g_byte_array_new();
-	const gsize blocksz = 0x10000;
-	gsize offset_add = 0;
-	gsize offset_cur = offset;
+	FuInputStreamFindHelper helper = {.buf = buf, .bufsz = bufsz};
+	g_autoptr(GError) error_local = NULL;
 
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
 	g_return_val_if_fail(buf != NULL, FALSE);
 	g_return_val_if_fail(bufsz != 0, FALSE);
-	g_return_val_if_fail(bufsz < blocksz, FALSE);
+	g_return_val_if_fail(bufsz < 0x10000, FALSE);
 	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
 
-	while (TRUE) {
-		g_autoptr(GByteArray) buf_tmp = NULL;
-		g_autoptr(GError) error_local = NULL;
-
-		/* read more data */
-		buf_tmp = fu_input_stream_read_byte_array(stream,
-							  offset_cur,
-							  blocksz,
-							  NULL,
-							  &error_local);
-		if (buf_tmp == NULL) {
-			if (g_error_matches(error_local, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE))
-				break;
+	if (!fu_input_stream_find_internal(stream,
+					   offset,
+					   bufsz - 1,
+					   fu_input_stream_find_cb,
+					   &helper,
+					   offset_found,
+					   &error_local)) {
+		if (error_local != NULL) {
 			g_propagate_error(error, g_steal_pointer(&error_local));
 			return FALSE;
 		}
-		g_byte_array_append(buf_acc, buf_tmp->data, buf_tmp->len);
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "failed to find buffer of size 0x%x",
+			    (guint)bufsz);
+		return FALSE;
+	}
+	return TRUE;
+}
 
-		/* we found something */
-		if (fu_memmem_safe(buf_acc->data, buf_acc->len, buf, bufsz, offset_found, NULL)) {
-			if (offset_found != NULL)
-				*offset_found += offset + offset_add;
+typedef struct {
+	GPtrArray *needles; /* of GBytes */
+	gboolean first_bytes[256];
+	guint idx;
+} FuInputStreamFindAnyHelper;
+
+static gboolean
+fu_input_stream_find_any_cb(const guint8 *buf,
+			    gsize bufsz,
+			    gsize limit,
+			    gsize *offset,
+			    gpointer user_data)
+{
+	FuInputStreamFindAnyHelper *helper = (FuInputStreamFindAnyHelper *)user_data;
+
+	for (gsize i = 0; i < limit; i++) {
+		/* most positions are rejected without looking at any needle */
+		if (!helper->first_bytes[buf[i]])
+			continue;
+		for (guint j = 0; j < helper->needles->len; j++) {
+			GBytes *needle = g_ptr_array_index(helper->needles, j);
+			gsize needlesz = 0;
+			const guint8 *needlebuf = g_bytes_get_data(needle, &needlesz);
+			if (needlesz > bufsz - i)
+				continue;
+			if (memcmp(buf + i, needlebuf, needlesz) != 0) /* nocheck:blocked */
+				continue;
+			helper->idx = j;
+			*offset = i;
 			return TRUE;
 		}
+	}
+	return FALSE;
+}
 
-		/* truncate the buffer */
-		if (buf_acc->len > bufsz) {
-			offset_add += buf_acc->len - bufsz;
-			g_byte_array_remove_range(buf_acc, 0, buf_acc->len - bufsz);
+/**
+ * fu_input_stream_find_any:
+ * @stream: a #GInputStream
+ * @needles: (element-type GBytes): buffers to look for
+ * @offset: starting offset, typically 0x0
+ * @idx_found: (nullable) (out): index of the needle that was found
+ * @offset_found: (nullable) (out): found offset
+ * @error: (nullable): optional return location for an error
+ *
+ * Finds the first of several memory buffers within an input stream in one pass, without loading
+ * the entire stream into a buffer.
+ *
+ * If more than one needle matches at the same offset then the one with the lowest index is used.
+ *
+ * Returns: %TRUE if any needle was found
+ *
+ * Since: 2.1.2
+ **/
+gboolean
+fu_input_stream_find_any(GInputStream *stream,
+			 GPtrArray *needles,
+			 gsize offset,
+			 guint *idx_found,
+			 gsize *offset_found,
+			 GError **error)
+{
+	FuInputStreamFindAnyHelper helper = {.needles = needles};
+	gsize needlesz_max = 0;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), FALSE);
+	g_return_val_if_fail(needles != NULL, FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* build the table of possible first bytes */
+	for (guint i = 0; i < needles->len; i++) {
+		GBytes *needle = g_ptr_array_index(needles, i);
+		gsize needlesz = 0;
+		const guint8 *needlebuf = g_bytes_get_data(needle, &needlesz);
+		if (needlesz == 0 || needlesz >= 0x10000) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "needle %u has invalid size 0x%x",
+				    i,
+				    (guint)needlesz);
+			return FALSE;
 		}
+		helper.first_bytes[needlebuf[0]] = TRUE;
+		needlesz_max = MAX(needlesz_max, needlesz);
+	}
 
-		/* move the offset */
-		offset_cur += buf_tmp->len;
+	if (needlesz_max == 0 || !fu_input_stream_find_internal(stream,
+								offset,
+								needlesz_max - 1,
+								fu_input_stream_find_any_cb,
+								&helper,
+								offset_found,
+								&error_local)) {
+		if (error_local != NULL) {
+			g_propagate_error(error, g_steal_pointer(&error_local));
+			return FALSE;
+		}
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_FOUND,
+			    "failed to find any of %u buffers",
+			    needles->len);
+		return FALSE;
 	}
-	g_set_error(error,
-		    FWUPD_ERROR,
-		    FWUPD_ERROR_NOT_FOUND,
-		    "failed to find buffer of size 0x%x",
-		    (guint)bufsz);
-	return FALSE;
+	if (idx_found != NULL)
+		*idx_found = helper.idx;
+	return TRUE;
 }
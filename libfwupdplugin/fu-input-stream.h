@@ -96,6 +96,9 @@ fu_input_stream_compute_crc16(GInputStream *stream, FuCrcKind kind, guint16 *crc
 gboolean
 fu_input_stream_compute_crc32(GInputStream *stream, FuCrcKind kind, guint32 *crc, GError **error)
     G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 3);
+GArray *
+fu_input_stream_find_crc_kinds(GInputStream *stream, guint32 crc_target, GError **error)
+    G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
 gchar *
 fu_input_stream_compute_checksum(GInputStream *stream,
 				 GChecksumType checksum_type,
@@ -107,3 +110,10 @@ fu_input_stream_find(GInputStream *stream,
 		     gsize offset,
 		     gsize *offset_found,
 		     GError **error) G_GNUC_NON_NULL(1, 2);
+gboolean
+fu_input_stream_find_any(GInputStream *stream,
+			 GPtrArray *needles,
+			 gsize offset,
+			 guint *idx_found,
+			 gsize *offset_found,
+			 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1, 2);
@@ -7,8 +7,208 @@
 #include "config.h"
 
 #include <lzma.h>
+#include <string.h>
 
+#include "fu-common.h"
+#include "fu-input-stream.h"
 #include "fu-lzma-common.h"
+#include "fu-mem.h"
+
+#define FU_LZMA_BUFSZ_MIN      0x20000 /* bytes */
+#define FU_LZMA_BUFSZ_MAX      (16 * FU_MB)
+#define FU_LZMA_BUFSZ_RATIO    16 /* of the compressed size */
+#define FU_LZMA_HEADER_SIZE    13 /* bytes, for .lzma and larger than .xz */
+#define FU_LZMA_INDEX_SIZE_MAX (1 * FU_MB)
+#define FU_LZMA_THREADS_MAX    2
+
+static const guint8 fu_lzma_xz_magic[] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
+
+typedef struct {
+	lzma_stream strm;
+	GByteArray *buf;
+	gsize bufsz; /* used, the rest of buf->data is allocated but not initialized */
+	gboolean done;
+} FuLzmaDecompressHelper;
+
+static void
+fu_lzma_decompress_helper_free(FuLzmaDecompressHelper *helper)
+{
+	lzma_end(&helper->strm);
+	if (helper->buf != NULL)
+		g_byte_array_unref(helper->buf);
+	g_free(helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuLzmaDecompressHelper, fu_lzma_decompress_helper_free)
+
+static gboolean
+fu_lzma_is_xz(const guint8 *buf, gsize bufsz)
+{
+	if (bufsz < sizeof(fu_lzma_xz_magic))
+		return FALSE;
+	return memcmp(buf, fu_lzma_xz_magic, sizeof(fu_lzma_xz_magic)) == 0;
+}
+
+/* uses the .xz index or the .lzma header, returning 0 if unknown */
+static guint64
+fu_lzma_get_uncompressed_size(GInputStream *stream,
+			      const guint8 *hdr,
+			      gsize hdrsz,
+			      gsize streamsz,
+			      guint64 *blocks)
+{
+	guint64 size = 0;
+	gsize in_pos = 0;
+	guint64 memlimit = G_MAXUINT64;
+	guint8 footer[LZMA_STREAM_HEADER_SIZE] = {0x0};
+	lzma_index *idx = NULL;
+	lzma_stream_flags flags = {0x0};
+	g_autofree guint8 *buf = NULL;
+
+	/* .lzma has properties, dictionary size and then the size, where -1 is unknown */
+	if (!fu_lzma_is_xz(hdr, hdrsz)) {
+		if (hdrsz < 4 || memcmp(hdr, "LZIP", 4) == 0)
+			return 0;
+		if (!fu_memread_uint64_safe(hdr, hdrsz, 0x5, &size, G_LITTLE_ENDIAN, NULL))
+			return 0;
+		return size != G_MAXUINT64 ? size : 0;
+	}
+
+	/* .xz has a footer which points to the index of all blocks */
+	if (streamsz < 2 * LZMA_STREAM_HEADER_SIZE)
+		return 0;
+	if (!fu_input_stream_read_safe(stream,
+				       footer,
+				       sizeof(footer),
+				       0x0,
+				       streamsz - sizeof(footer),
+				       sizeof(footer),
+				       NULL))
+		return 0;
+	if (lzma_stream_footer_decode(&flags, footer) != LZMA_OK)
+		return 0;
+	if (flags.backward_size > FU_LZMA_INDEX_SIZE_MAX ||
+	    flags.backward_size > streamsz - 2 * LZMA_STREAM_HEADER_SIZE)
+		return 0;
+	buf = g_malloc0(flags.backward_size);
+	if (!fu_input_stream_read_safe(stream,
+				       buf,
+				       flags.backward_size,
+				       0x0,
+				       streamsz - sizeof(footer) - flags.backward_size,
+				       flags.backward_size,
+				       NULL))
+		return 0;
+	if (lzma_index_buffer_decode(&idx, &memlimit, NULL, buf, &in_pos, flags.backward_size) !=
+	    LZMA_OK)
+		return 0;
+	size = lzma_index_uncompressed_size(idx);
+	*blocks = lzma_index_block_count(idx);
+	lzma_index_end(idx, NULL);
+	return size;
+}
+
+static FuLzmaDecompressHelper *
+fu_lzma_decompress_helper_new(GInputStream *stream, guint64 memlimit, GError **error)
+{
+	guint8 hdr[FU_LZMA_HEADER_SIZE] = {0x0};
+	gsize bufsz;
+	gsize hdrsz;
+	gsize streamsz = 0;
+	guint64 blocks = 0;
+	guint64 size;
+	lzma_ret rc;
+	g_autoptr(FuLzmaDecompressHelper) helper = g_new0(FuLzmaDecompressHelper, 1);
+
+	/* the magic is only needed to choose a decoder, and so a short read is fine */
+	if (!fu_input_stream_size(stream, &streamsz, error))
+		return NULL;
+	hdrsz = MIN(streamsz, sizeof(hdr));
+	if (!fu_input_stream_read_safe(stream, hdr, sizeof(hdr), 0x0, 0x0, hdrsz, error))
+		return NULL;
+
+	/* preallocate when the uncompressed size is known, but do not trust it as the memory
+	 * limit does not bound the output size -- the buffer is grown if it was too small; the
+	 * extra byte means the decoder never runs out of space when the size was correct */
+	size = fu_lzma_get_uncompressed_size(stream, hdr, hdrsz, streamsz, &blocks);
+	size = MIN(size, MAX((guint64)streamsz * FU_LZMA_BUFSZ_RATIO, FU_LZMA_BUFSZ_MIN));
+	size = MIN(size, FU_LZMA_BUFSZ_MAX);
+	bufsz = MAX(size + 1, FU_LZMA_BUFSZ_MIN);
+	helper->buf = g_byte_array_sized_new(bufsz);
+	g_byte_array_set_size(helper->buf, bufsz);
+
+#if defined(HAVE_LZMA_STREAM_DECODER_MT) && !defined(HAVE_FUZZER)
+	/* only .xz can be decoded in parallel, and only if it was encoded with multiple blocks --
+	 * the daemon may be parsing other firmware at the same time and so use few threads */
+	if (fu_lzma_is_xz(hdr, hdrsz) && blocks > 1) {
+		lzma_mt mt = {
+		    .flags = LZMA_TELL_UNSUPPORTED_CHECK,
+		    .threads = MIN(MIN(g_get_num_processors(), FU_LZMA_THREADS_MAX), blocks),
+		    .memlimit_threading = memlimit,
+		    .memlimit_stop = memlimit,
+		};
+		rc = lzma_stream_decoder_mt(&helper->strm, &mt);
+	} else {
+		rc = lzma_auto_decoder(&helper->strm, memlimit, LZMA_TELL_UNSUPPORTED_CHECK);
+	}
+#else
+	rc = lzma_auto_decoder(&helper->strm, memlimit, LZMA_TELL_UNSUPPORTED_CHECK);
+#endif
+	if (rc != LZMA_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to set up LZMA decoder rc=%u",
+			    rc);
+		return NULL;
+	}
+	return g_steal_pointer(&helper);
+}
+
+/* decodes directly into the output buffer, which is only grown if the size was unknown */
+static gboolean
+fu_lzma_decompress_helper_code(FuLzmaDecompressHelper *helper, lzma_action action, GError **error)
+{
+	while (!helper->done) {
+		lzma_ret rc;
+
+		if (helper->bufsz == helper->buf->len)
+			g_byte_array_set_size(helper->buf, helper->buf->len * 2);
+		helper->strm.next_out = helper->buf->data + helper->bufsz;
+		helper->strm.avail_out = helper->buf->len - helper->bufsz;
+		rc = lzma_code(&helper->strm, action);
+		helper->bufsz = helper->buf->len - helper->strm.avail_out;
+		if (rc == LZMA_STREAM_END) {
+			helper->done = TRUE;
+			break;
+		}
+		if (rc != LZMA_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to decode LZMA data rc=%u",
+				    rc);
+			return FALSE;
+		}
+
+		/* needs more input */
+		if (action == LZMA_RUN && helper->strm.avail_in == 0 &&
+		    helper->strm.avail_out > 0)
+			break;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static GBytes *
+fu_lzma_decompress_helper_finish(FuLzmaDecompressHelper *helper, GError **error)
+{
+	if (!fu_lzma_decompress_helper_code(helper, LZMA_FINISH, error))
+		return NULL;
+	g_byte_array_set_size(helper->buf, helper->bufsz);
+	return g_byte_array_free_to_bytes(g_steal_pointer(&helper->buf)); /* nocheck:blocked */
+}
 
 /**
  * fu_lzma_decompress_bytes:
@@ -25,45 +225,59 @@
 GBytes *
 fu_lzma_decompress_bytes(GBytes *blob, guint64 memlimit, GError **error)
 {
-	const gsize tmpbufsz = 0x20000;
-	lzma_ret rc;
-	lzma_stream strm = LZMA_STREAM_INIT;
-	g_autofree guint8 *tmpbuf = g_malloc0(tmpbufsz);
-	g_autoptr(GByteArray) buf = g_byte_array_new();
-
-	strm.next_in = g_bytes_get_data(blob, NULL);
-	strm.avail_in = g_bytes_get_size(blob);
+	g_autoptr(FuLzmaDecompressHelper) helper = NULL;
+	g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes(blob);
 
-	rc = lzma_auto_decoder(&strm, memlimit, LZMA_TELL_UNSUPPORTED_CHECK);
-	if (rc != LZMA_OK) {
-		lzma_end(&strm);
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "failed to set up LZMA decoder rc=%u",
-			    rc);
+	helper = fu_lzma_decompress_helper_new(stream, memlimit, error);
+	if (helper == NULL)
 		return NULL;
-	}
-	do {
-		strm.next_out = tmpbuf;
-		strm.avail_out = tmpbufsz;
-		rc = lzma_code(&strm, LZMA_RUN);
-		if (rc != LZMA_OK && rc != LZMA_STREAM_END)
-			break;
-		g_byte_array_append(buf, tmpbuf, tmpbufsz - strm.avail_out);
-	} while (rc == LZMA_OK);
-	lzma_end(&strm);
+	helper->strm.next_in = g_bytes_get_data(blob, NULL);
+	helper->strm.avail_in = g_bytes_get_size(blob);
+	return fu_lzma_decompress_helper_finish(helper, error);
+}
 
-	/* success */
-	if (rc != LZMA_OK && rc != LZMA_STREAM_END) {
-		g_set_error(error,
-			    FWUPD_ERROR,
-			    FWUPD_ERROR_NOT_SUPPORTED,
-			    "failed to decode LZMA data rc=%u",
-			    rc);
+static gboolean
+fu_lzma_decompress_stream_cb(const guint8 *buf, gsize bufsz, gpointer user_data, GError **error)
+{
+	FuLzmaDecompressHelper *helper = (FuLzmaDecompressHelper *)user_data;
+
+	/* ignore any trailing data */
+	if (helper->done)
+		return TRUE;
+	helper->strm.next_in = buf;
+	helper->strm.avail_in = bufsz;
+	return fu_lzma_decompress_helper_code(helper, LZMA_RUN, error);
+}
+
+/**
+ * fu_lzma_decompress_stream_to_bytes:
+ * @stream: a #GInputStream
+ * @memlimit: decompression memory limit, in bytes
+ * @error: (nullable): optional return location for an error
+ *
+ * Decompresses a LZMA stream. The compressed data is read in chunks rather than all at once,
+ * but all of the decompressed data is returned in memory.
+ *
+ * Returns: (transfer full): decompressed data
+ *
+ * Since: 2.1.2
+ **/
+GBytes *
+fu_lzma_decompress_stream_to_bytes(GInputStream *stream, guint64 memlimit, GError **error)
+{
+	g_autoptr(FuLzmaDecompressHelper) helper = NULL;
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	helper = fu_lzma_decompress_helper_new(stream, memlimit, error);
+	if (helper == NULL)
 		return NULL;
-	}
-	return g_bytes_new(buf->data, buf->len);
+	if (!fu_input_stream_chunkify(stream, fu_lzma_decompress_stream_cb, helper, error))
+		return NULL;
+	helper->strm.next_in = NULL;
+	helper->strm.avail_in = 0;
+	return fu_lzma_decompress_helper_finish(helper, error);
 }
 
 /**
@@ -11,4 +11,7 @@
 GBytes *
 fu_lzma_decompress_bytes(GBytes *blob, guint64 memlimit, GError **error) G_GNUC_NON_NULL(1);
 GBytes *
+fu_lzma_decompress_stream_to_bytes(GInputStream *stream, guint64 memlimit, GError **error)
+    G_GNUC_NON_NULL(1);
+GBytes *
 fu_lzma_compress_bytes(GBytes *blob, GError **error) G_GNUC_NON_NULL(1);
@@ -42,10 +42,53 @@ fu_lzma_func(void)
 	g_assert_true(ret);
 }
 
+static void
+fu_lzma_stream_func(void)
+{
+	gboolean ret;
+	g_autoptr(GByteArray) buf_in = g_byte_array_new();
+	g_autoptr(GBytes) blob_in = NULL;
+	g_autoptr(GBytes) blob_orig = NULL;
+	g_autoptr(GBytes) blob_out = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream_out = NULL;
+
+	/* larger than one chunk, so the decoder is fed more than once */
+	for (guint i = 0; i < 0x100000; i++)
+		fu_byte_array_append_uint8(buf_in, (guint8)((i * 7) ^ (i >> 11)));
+	blob_in = g_bytes_new(buf_in->data, buf_in->len);
+	blob_out = fu_lzma_compress_bytes(blob_in, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_out);
+
+	/* decompress, where the .xz index is used to allocate the output */
+	stream_out = g_memory_input_stream_new_from_bytes(blob_out);
+	blob_orig = fu_lzma_decompress_stream_to_bytes(stream_out, 128 * FU_MB, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob_orig);
+	ret = fu_bytes_compare(blob_in, blob_orig, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+}
+
+static void
+fu_lzma_invalid_func(void)
+{
+	g_autoptr(GBytes) blob = g_bytes_new_static("\xFD" "7zXZ\0hello", 11);
+	g_autoptr(GBytes) blob_orig = NULL;
+	g_autoptr(GError) error = NULL;
+
+	blob_orig = fu_lzma_decompress_bytes(blob, 128 * FU_MB, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_null(blob_orig);
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/lzma", fu_lzma_func);
+	g_test_add_func("/fwupd/lzma/stream", fu_lzma_stream_func);
+	g_test_add_func("/fwupd/lzma/invalid", fu_lzma_invalid_func);
 	return g_test_run();
 }
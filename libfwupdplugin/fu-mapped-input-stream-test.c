@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <fwupdplugin.h>
+
+static void
+fu_mapped_input_stream_func(void)
+{
+	gboolean ret;
+	gint rc;
+	guint8 buf[4] = {0};
+	guint32 value = 0;
+	g_autofree gchar *fn = NULL;
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) partial_stream = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* deleted on error */
+	tmpdir = fu_temporary_directory_new("mapped-input-stream", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fn = fu_temporary_directory_build(tmpdir, "fwupd.bin", NULL);
+	ret = g_file_set_contents(fn, "12345678", 8, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* regular files get mapped */
+	stream = fu_input_stream_from_path(fn, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(stream);
+	g_assert_true(FU_IS_MAPPED_INPUT_STREAM(stream));
+
+	/* read the 12 */
+	rc = g_input_stream_read(stream, buf, 2, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(rc, ==, 2);
+	g_assert_cmpint(buf[0], ==, '1');
+	g_assert_cmpint(buf[1], ==, '2');
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(stream)), ==, 0x2);
+
+	/* read the 5678 using the helper, which also moves the position */
+	ret = fu_input_stream_read_u32(stream, 0x4, &value, G_BIG_ENDIAN, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	g_assert_cmpint(value, ==, 0x35363738);
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(stream)), ==, 0x8);
+
+	/* there is no more data to read */
+	rc = g_input_stream_read(stream, buf, sizeof(buf), NULL, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(rc, ==, 0);
+	ret = fu_input_stream_read_u32(stream, 0x6, &value, G_BIG_ENDIAN, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_false(ret);
+	g_clear_error(&error);
+
+	/* borrow the mapping using a slice */
+	partial_stream = fu_partial_input_stream_new(stream, 2, 4, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(partial_stream);
+	blob = fu_input_stream_read_bytes(partial_stream, 0x1, G_MAXSIZE, NULL, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blob);
+	g_assert_cmpint(g_bytes_get_size(blob), ==, 3);
+	g_assert_cmpint(memcmp(g_bytes_get_data(blob, NULL), "456", 3), ==, 0);
+	g_assert_cmpint(g_seekable_tell(G_SEEKABLE(partial_stream)), ==, 0x4);
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/mapped-input-stream", fu_mapped_input_stream_func);
+	return g_test_run();
+}
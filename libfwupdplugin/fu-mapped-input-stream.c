@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuMappedInputStream"
+
+#include "config.h"
+
+#include "fwupd-codec.h"
+#include "fwupd-error.h"
+
+#include "fu-mapped-input-stream-private.h"
+
+/**
+ * FuMappedInputStream:
+ *
+ * A seekable input stream that reads from a memory mapped local file.
+ *
+ * Reading and seeking do not need any syscalls, and the helpers in fu-input-stream.c can use the
+ * mapping directly rather than copying the data.
+ */
+
+struct _FuMappedInputStream {
+	GInputStream parent_instance;
+	GBytes *blob;
+	gsize pos;
+};
+
+static void
+fu_mapped_input_stream_seekable_iface_init(GSeekableIface *iface);
+static void
+fu_mapped_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuMappedInputStream,
+			fu_mapped_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_mapped_input_stream_seekable_iface_init)
+			    G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+						  fu_mapped_input_stream_codec_iface_init))
+
+static void
+fu_mapped_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "Pos", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "Size", g_bytes_get_size(self->blob));
+}
+
+static void
+fu_mapped_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_mapped_input_stream_add_string;
+}
+
+static goffset
+fu_mapped_input_stream_tell(GSeekable *seekable)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(seekable);
+	return self->pos;
+}
+
+static gboolean
+fu_mapped_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_mapped_input_stream_seek(GSeekable *seekable,
+			    goffset offset,
+			    GSeekType type,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(seekable);
+	goffset pos = offset;
+
+	g_return_val_if_fail(FU_IS_MAPPED_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (type == G_SEEK_CUR)
+		pos += self->pos;
+	else if (type == G_SEEK_END)
+		pos += g_bytes_get_size(self->blob);
+
+	/* like a file, seeking past the end is allowed but reads will return nothing */
+	if (pos < 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "cannot seek to negative offset %" G_GINT64_FORMAT,
+			    (gint64)pos);
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_mapped_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_mapped_input_stream_truncate(GSeekable *seekable,
+				goffset offset,
+				GCancellable *cancellable,
+				GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuMappedInputStream");
+	return FALSE;
+}
+
+static void
+fu_mapped_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_mapped_input_stream_tell;
+	iface->can_seek = fu_mapped_input_stream_can_seek;
+	iface->seek = fu_mapped_input_stream_seek;
+	iface->can_truncate = fu_mapped_input_stream_can_truncate;
+	iface->truncate_fn = fu_mapped_input_stream_truncate;
+}
+
+/**
+ * fu_mapped_input_stream_new:
+ * @filename: a local filename
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an input stream where content is read from a read-only memory mapping of the file.
+ *
+ * Returns: (transfer full): a #FuMappedInputStream, or %NULL on error
+ *
+ * Since: 2.1.2
+ **/
+GInputStream *
+fu_mapped_input_stream_new(const gchar *filename, GError **error)
+{
+	g_autoptr(FuMappedInputStream) self = g_object_new(FU_TYPE_MAPPED_INPUT_STREAM, NULL);
+	g_autoptr(GMappedFile) mapped_file = NULL;
+
+	g_return_val_if_fail(filename != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	mapped_file = g_mapped_file_new(filename, FALSE, error);
+	if (mapped_file == NULL) {
+		fwupd_error_convert(error);
+		return NULL;
+	}
+
+	/* files in procfs have no size, and have to be read instead */
+	if (g_mapped_file_get_length(mapped_file) == 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "%s has zero size",
+			    filename);
+		return NULL;
+	}
+	self->blob = g_mapped_file_get_bytes(mapped_file);
+
+	/* success */
+	return G_INPUT_STREAM(g_steal_pointer(&self));
+}
+
+/* private */
+GBytes *
+fu_mapped_input_stream_get_bytes(FuMappedInputStream *self)
+{
+	g_return_val_if_fail(FU_IS_MAPPED_INPUT_STREAM(self), NULL);
+	return self->blob;
+}
+
+static gssize
+fu_mapped_input_stream_read(GInputStream *stream,
+			    void *buffer,
+			    gsize count,
+			    GCancellable *cancellable,
+			    GError **error)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(stream);
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data(self->blob, &bufsz);
+
+	g_return_val_if_fail(FU_IS_MAPPED_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	if (self->pos >= bufsz)
+		return 0;
+	count = MIN(count, bufsz - self->pos);
+	memcpy(buffer, buf + self->pos, count); /* nocheck:blocked */
+	self->pos += count;
+	return count;
+}
+
+static void
+fu_mapped_input_stream_finalize(GObject *object)
+{
+	FuMappedInputStream *self = FU_MAPPED_INPUT_STREAM(object);
+	if (self->blob != NULL)
+		g_bytes_unref(self->blob);
+	G_OBJECT_CLASS(fu_mapped_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_mapped_input_stream_class_init(FuMappedInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_mapped_input_stream_read;
+	object_class->finalize = fu_mapped_input_stream_finalize;
+}
+
+static void
+fu_mapped_input_stream_init(FuMappedInputStream *self)
+{
+}
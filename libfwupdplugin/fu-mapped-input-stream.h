@@ -0,0 +1,20 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupd.h>
+
+#define FU_TYPE_MAPPED_INPUT_STREAM (fu_mapped_input_stream_get_type())
+
+G_DECLARE_FINAL_TYPE(FuMappedInputStream,
+		     fu_mapped_input_stream,
+		     FU,
+		     MAPPED_INPUT_STREAM,
+		     GInputStream)
+
+GInputStream *
+fu_mapped_input_stream_new(const gchar *filename, GError **error) G_GNUC_NON_NULL(1);
@@ -485,6 +485,8 @@ fu_memmem_safe(const guint8 *haystack,
 {
 #ifdef HAVE_MEMMEM
 	const guint8 *tmp;
+#else
+	gsize skip[256];
 #endif
 	g_return_val_if_fail(haystack != NULL, FALSE);
 	g_return_val_if_fail(needle != NULL, FALSE);
@@ -517,12 +519,21 @@ fu_memmem_safe(const guint8 *haystack,
 		return TRUE;
 	}
 #else
-	for (gsize i = 0; i < haystack_sz - needle_sz; i++) {
-		if (memcmp(haystack + i, needle, needle_sz) == 0) {
+	/* Boyer-Moore-Horspool: shift by the distance of the last byte of the window from the end
+	 * of the needle, so most windows are skipped without comparing the whole needle */
+	for (guint i = 0; i < G_N_ELEMENTS(skip); i++)
+		skip[i] = needle_sz;
+	for (gsize i = 0; i < needle_sz - 1; i++)
+		skip[needle[i]] = needle_sz - 1 - i;
+	for (gsize i = 0; i <= haystack_sz - needle_sz;) {
+		guint8 last = haystack[i + needle_sz - 1];
+		if (last == needle[needle_sz - 1] &&
+		    memcmp(haystack + i, needle, needle_sz - 1) == 0) {
 			if (offset != NULL)
 				*offset = i;
 			return TRUE;
 		}
+		i += skip[last];
 	}
 #endif
 
@@ -0,0 +1,507 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuMszipInputStream"
+
+#include "config.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include "fwupd-codec.h"
+
+#include "fu-common.h"
+#include "fu-input-stream.h"
+#include "fu-mem.h"
+#include "fu-mszip-input-stream.h"
+
+/**
+ * FuMszipInputStream:
+ *
+ * An input stream of a cabinet folder, where the MSZIP blocks are decompressed as the data is
+ * read rather than all at once.
+ *
+ * Each block uses the uncompressed data of the previous block as the deflate dictionary, so
+ * to seek backwards the dictionary is saved every few blocks. This means that reading any
+ * offset only needs decompressing at most %FU_MSZIP_INPUT_STREAM_CHECKPOINT_INTERVAL blocks.
+ */
+
+#define FU_MSZIP_INPUT_STREAM_BLOCK_SIZE_MAX	  0x8000  /* bytes, also zlib dictionary max */
+#define FU_MSZIP_INPUT_STREAM_COMP_SIZE_MAX	  0x10000 /* bytes, as CFDATA.comp is u16 */
+#define FU_MSZIP_INPUT_STREAM_CHECKPOINT_INTERVAL 64	  /* blocks */
+
+typedef struct {
+	gsize offset;	     /* in base stream, including the signature */
+	gsize size_comp;     /* including the signature */
+	gsize size_uncomp;   /* bytes */
+	gsize global_offset; /* uncompressed */
+	GBytes *dictionary;  /* nullable, only for checkpoints */
+} FuMszipInputStreamBlock;
+
+struct _FuMszipInputStream {
+	GInputStream parent_instance;
+	GInputStream *base_stream;
+	GPtrArray *blocks; /* of FuMszipInputStreamBlock */
+	z_stream zstrm;
+	guint8 *buf_comp; /* of size FU_MSZIP_INPUT_STREAM_COMP_SIZE_MAX */
+	guint8 *buf;	  /* of size FU_MSZIP_INPUT_STREAM_BLOCK_SIZE_MAX */
+	gsize bufsz;	  /* valid uncompressed data in buf */
+	guint buf_idx;	  /* block index of buf, or G_MAXUINT */
+	goffset pos;
+	gsize total_size;
+};
+
+static void
+fu_mszip_input_stream_seekable_iface_init(GSeekableIface *iface);
+static void
+fu_mszip_input_stream_codec_iface_init(FwupdCodecInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(FuMszipInputStream,
+			fu_mszip_input_stream,
+			G_TYPE_INPUT_STREAM,
+			G_IMPLEMENT_INTERFACE(G_TYPE_SEEKABLE,
+					      fu_mszip_input_stream_seekable_iface_init)
+			    G_IMPLEMENT_INTERFACE(FWUPD_TYPE_CODEC,
+						  fu_mszip_input_stream_codec_iface_init))
+
+static void
+fu_mszip_input_stream_add_string(FwupdCodec *codec, guint idt, GString *str)
+{
+	FuMszipInputStream *self = FU_MSZIP_INPUT_STREAM(codec);
+	fwupd_codec_string_append_hex(str, idt, "Pos", self->pos);
+	fwupd_codec_string_append_hex(str, idt, "TotalSize", self->total_size);
+	fwupd_codec_string_append_int(str, idt, "Blocks", self->blocks->len);
+}
+
+static void
+fu_mszip_input_stream_codec_iface_init(FwupdCodecInterface *iface)
+{
+	iface->add_string = fu_mszip_input_stream_add_string;
+}
+
+static void
+fu_mszip_input_stream_block_free(FuMszipInputStreamBlock *block)
+{
+	if (block->dictionary != NULL)
+		g_bytes_unref(block->dictionary);
+	g_free(block);
+}
+
+static voidpf
+fu_mszip_input_stream_zalloc(voidpf opaque, uInt items, uInt size)
+{
+	return g_malloc0_n(items, size);
+}
+
+static void
+fu_mszip_input_stream_zfree(voidpf opaque, voidpf address)
+{
+	g_free(address);
+}
+
+/* the dictionary is the uncompressed data of the previous block, and may be self->buf */
+static gboolean
+fu_mszip_input_stream_inflate_block(FuMszipInputStream *self,
+				    guint idx,
+				    const guint8 *dict,
+				    gsize dictsz,
+				    GError **error)
+{
+	FuMszipInputStreamBlock *block = g_ptr_array_index(self->blocks, idx);
+	int zret;
+	g_autofree gchar *kind = NULL;
+
+	/* invalidate in case of failure */
+	self->buf_idx = G_MAXUINT;
+	self->bufsz = 0;
+
+	zret = inflateReset(&self->zstrm);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to reset inflate: %s",
+			    zError(zret));
+		return FALSE;
+	}
+	if (dictsz > 0) {
+		zret = inflateSetDictionary(&self->zstrm, dict, dictsz);
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "failed to set inflate dictionary: %s",
+				    zError(zret));
+			return FALSE;
+		}
+	}
+
+	/* check compressed header */
+	if (!fu_input_stream_read_safe(self->base_stream,
+				       self->buf_comp,
+				       FU_MSZIP_INPUT_STREAM_COMP_SIZE_MAX,
+				       0x0,
+				       block->offset,
+				       block->size_comp,
+				       error))
+		return FALSE;
+	kind = fu_memstrsafe(self->buf_comp, block->size_comp, 0x0, 2, error);
+	if (kind == NULL)
+		return FALSE;
+	if (g_strcmp0(kind, "CK") != 0) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "compressed header invalid: %s",
+			    kind);
+		return FALSE;
+	}
+
+	/* decompress Zlib data after removing the signature */
+	self->zstrm.avail_in = block->size_comp - 2;
+	self->zstrm.next_in = self->buf_comp + 2;
+	self->zstrm.avail_out = FU_MSZIP_INPUT_STREAM_BLOCK_SIZE_MAX;
+	self->zstrm.next_out = self->buf;
+	while (1) {
+		gsize bufsz;
+		zret = inflate(&self->zstrm, Z_BLOCK);
+		bufsz = FU_MSZIP_INPUT_STREAM_BLOCK_SIZE_MAX - self->zstrm.avail_out;
+		if (bufsz > block->size_uncomp) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INVALID_DATA,
+				    "decompressed size mismatch (0x%x, specified 0x%x)",
+				    (guint)bufsz,
+				    (guint)block->size_uncomp);
+			return FALSE;
+		}
+		if (zret == Z_STREAM_END)
+			break;
+		if (zret != Z_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOT_SUPPORTED,
+				    "inflate error @0x%x: %s",
+				    (guint)block->offset,
+				    zError(zret));
+			return FALSE;
+		}
+	}
+
+	/* verify actual decompressed size matches declared size */
+	if (self->zstrm.total_out != block->size_uncomp) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "decompressed size mismatch (0x%x, specified 0x%x)",
+			    (guint)self->zstrm.total_out,
+			    (guint)block->size_uncomp);
+		return FALSE;
+	}
+
+	/* success */
+	self->buf_idx = idx;
+	self->bufsz = block->size_uncomp;
+	return TRUE;
+}
+
+static gboolean
+fu_mszip_input_stream_ensure_block(FuMszipInputStream *self, guint idx, GError **error)
+{
+	guint idx_checkpoint = idx - (idx % FU_MSZIP_INPUT_STREAM_CHECKPOINT_INTERVAL);
+	guint idx_start = idx_checkpoint;
+	const guint8 *dict = NULL;
+	gsize dictsz = 0;
+
+	/* already decompressed */
+	if (self->buf_idx == idx)
+		return TRUE;
+
+	/* continue on from the current block if closer than the checkpoint */
+	if (self->buf_idx != G_MAXUINT && self->buf_idx < idx &&
+	    self->buf_idx + 1 >= idx_checkpoint) {
+		idx_start = self->buf_idx + 1;
+		dict = self->buf;
+		dictsz = self->bufsz;
+	} else if (idx_checkpoint > 0) {
+		FuMszipInputStreamBlock *block = g_ptr_array_index(self->blocks, idx_checkpoint);
+		if (block->dictionary == NULL) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_INTERNAL,
+				    "no dictionary for block 0x%x",
+				    idx_checkpoint);
+			return FALSE;
+		}
+		dict = g_bytes_get_data(block->dictionary, &dictsz);
+	}
+
+	/* decompress each block in turn, saving the dictionary of each checkpoint */
+	for (guint i = idx_start; i <= idx; i++) {
+		FuMszipInputStreamBlock *block = g_ptr_array_index(self->blocks, i);
+		if (i > 0 && i % FU_MSZIP_INPUT_STREAM_CHECKPOINT_INTERVAL == 0 &&
+		    block->dictionary == NULL)
+			block->dictionary = g_bytes_new(dict, dictsz);
+		if (!fu_mszip_input_stream_inflate_block(self, i, dict, dictsz, error))
+			return FALSE;
+		dict = self->buf;
+		dictsz = self->bufsz;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+/**
+ * fu_mszip_input_stream_add_block:
+ * @self: a #FuMszipInputStream
+ * @offset: offset of the compressed data in the base stream, including the `CK` signature
+ * @size_comp: size of the compressed data, including the signature
+ * @size_uncomp: size of the uncompressed data
+ * @error: (nullable): optional return location for an error
+ *
+ * Adds a CFDATA block to the end of the folder. The block is decompressed to verify it is
+ * valid, but the uncompressed data is not kept.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 2.1.2
+ **/
+gboolean
+fu_mszip_input_stream_add_block(FuMszipInputStream *self,
+				gsize offset,
+				gsize size_comp,
+				gsize size_uncomp,
+				GError **error)
+{
+	FuMszipInputStreamBlock *block;
+
+	g_return_val_if_fail(FU_IS_MSZIP_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	/* sanity check */
+	if (size_comp > FU_MSZIP_INPUT_STREAM_COMP_SIZE_MAX) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "compressed size 0x%x too large",
+			    (guint)size_comp);
+		return FALSE;
+	}
+	if (size_uncomp > FU_MSZIP_INPUT_STREAM_BLOCK_SIZE_MAX) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "dictionary size 0x%x exceeds zlib maximum",
+			    (guint)size_uncomp);
+		return FALSE;
+	}
+
+	block = g_new0(FuMszipInputStreamBlock, 1);
+	block->offset = offset;
+	block->size_comp = size_comp;
+	block->size_uncomp = size_uncomp;
+	block->global_offset = self->total_size;
+	g_ptr_array_add(self->blocks, block);
+	if (!fu_size_checked_inc(&self->total_size, size_uncomp, error)) {
+		g_prefix_error_literal(error, "total size overflow: ");
+		return FALSE;
+	}
+
+	/* this is sequential, and so only decompresses the new block */
+	return fu_mszip_input_stream_ensure_block(self, self->blocks->len - 1, error);
+}
+
+static goffset
+fu_mszip_input_stream_tell(GSeekable *seekable)
+{
+	FuMszipInputStream *self = FU_MSZIP_INPUT_STREAM(seekable);
+	g_return_val_if_fail(FU_IS_MSZIP_INPUT_STREAM(self), -1);
+	return self->pos;
+}
+
+static gboolean
+fu_mszip_input_stream_can_seek(GSeekable *seekable)
+{
+	return TRUE;
+}
+
+static gboolean
+fu_mszip_input_stream_seek(GSeekable *seekable,
+			   goffset offset,
+			   GSeekType type,
+			   GCancellable *cancellable,
+			   GError **error)
+{
+	FuMszipInputStream *self = FU_MSZIP_INPUT_STREAM(seekable);
+	goffset pos;
+
+	g_return_val_if_fail(FU_IS_MSZIP_INPUT_STREAM(self), FALSE);
+	g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+	if (type == G_SEEK_CUR) {
+		pos = self->pos + offset;
+	} else if (type == G_SEEK_END) {
+		pos = self->total_size + offset;
+	} else {
+		pos = offset;
+	}
+	if (pos < 0 || (gsize)pos > self->total_size) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_INVALID_DATA,
+			    "requested position 0x%x outside of 0x%x",
+			    (guint)pos,
+			    (guint)self->total_size);
+		return FALSE;
+	}
+	self->pos = pos;
+	return TRUE;
+}
+
+static gboolean
+fu_mszip_input_stream_can_truncate(GSeekable *seekable)
+{
+	return FALSE;
+}
+
+static gboolean
+fu_mszip_input_stream_truncate(GSeekable *seekable,
+			       goffset offset,
+			       GCancellable *cancellable,
+			       GError **error)
+{
+	g_set_error_literal(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "cannot truncate FuMszipInputStream");
+	return FALSE;
+}
+
+static void
+fu_mszip_input_stream_seekable_iface_init(GSeekableIface *iface)
+{
+	iface->tell = fu_mszip_input_stream_tell;
+	iface->can_seek = fu_mszip_input_stream_can_seek;
+	iface->seek = fu_mszip_input_stream_seek;
+	iface->can_truncate = fu_mszip_input_stream_can_truncate;
+	iface->truncate_fn = fu_mszip_input_stream_truncate;
+}
+
+static guint
+fu_mszip_input_stream_get_block_for_offset(FuMszipInputStream *self, gsize offset)
+{
+	guint lo = 0;
+	guint hi = self->blocks->len;
+
+	while (lo + 1 < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		FuMszipInputStreamBlock *block = g_ptr_array_index(self->blocks, mid);
+		if (offset < block->global_offset)
+			hi = mid;
+		else
+			lo = mid;
+	}
+	return lo;
+}
+
+static gssize
+fu_mszip_input_stream_read(GInputStream *stream,
+			   void *buffer,
+			   gsize count,
+			   GCancellable *cancellable,
+			   GError **error)
+{
+	FuMszipInputStream *self = FU_MSZIP_INPUT_STREAM(stream);
+	FuMszipInputStreamBlock *block;
+	gsize offset;
+	guint idx;
+
+	g_return_val_if_fail(FU_IS_MSZIP_INPUT_STREAM(self), -1);
+	g_return_val_if_fail(error == NULL || *error == NULL, -1);
+
+	/* EOF */
+	if (self->pos < 0 || (gsize)self->pos >= self->total_size)
+		return 0;
+
+	idx = fu_mszip_input_stream_get_block_for_offset(self, self->pos);
+	if (!fu_mszip_input_stream_ensure_block(self, idx, error))
+		return -1;
+	block = g_ptr_array_index(self->blocks, idx);
+	offset = self->pos - block->global_offset;
+	count = MIN(count, self->bufsz - offset);
+	memcpy(buffer, self->buf + offset, count); /* nocheck:blocked */
+	self->pos += count;
+	return count;
+}
+
+/**
+ * fu_mszip_input_stream_new:
+ * @stream: a base #GInputStream, typically of the whole cabinet archive
+ * @error: (nullable): optional return location for an error
+ *
+ * Creates an empty input stream, where blocks are then added with
+ * fu_mszip_input_stream_add_block().
+ *
+ * Returns: (transfer full): a #FuMszipInputStream, or %NULL on error
+ *
+ * Since: 2.1.2
+ **/
+GInputStream *
+fu_mszip_input_stream_new(GInputStream *stream, GError **error)
+{
+	int zret;
+	g_autoptr(FuMszipInputStream) self = g_object_new(FU_TYPE_MSZIP_INPUT_STREAM, NULL);
+
+	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	zret = inflateInit2(&self->zstrm, -MAX_WBITS);
+	if (zret != Z_OK) {
+		g_set_error(error,
+			    FWUPD_ERROR,
+			    FWUPD_ERROR_NOT_SUPPORTED,
+			    "failed to initialize inflate: %s",
+			    zError(zret));
+		return NULL;
+	}
+	self->base_stream = g_object_ref(stream);
+	return G_INPUT_STREAM(g_steal_pointer(&self));
+}
+
+static void
+fu_mszip_input_stream_finalize(GObject *object)
+{
+	FuMszipInputStream *self = FU_MSZIP_INPUT_STREAM(object);
+	inflateEnd(&self->zstrm);
+	if (self->base_stream != NULL)
+		g_object_unref(self->base_stream);
+	g_ptr_array_unref(self->blocks);
+	g_free(self->buf_comp);
+	g_free(self->buf);
+	G_OBJECT_CLASS(fu_mszip_input_stream_parent_class)->finalize(object);
+}
+
+static void
+fu_mszip_input_stream_class_init(FuMszipInputStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	GInputStreamClass *istream_class = G_INPUT_STREAM_CLASS(klass);
+	istream_class->read_fn = fu_mszip_input_stream_read;
+	object_class->finalize = fu_mszip_input_stream_finalize;
+}
+
+static void
+fu_mszip_input_stream_init(FuMszipInputStream *self)
+{
+	self->blocks =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_mszip_input_stream_block_free);
+	self->buf_comp = g_malloc0(FU_MSZIP_INPUT_STREAM_COMP_SIZE_MAX);
+	self->buf = g_malloc0(FU_MSZIP_INPUT_STREAM_BLOCK_SIZE_MAX);
+	self->buf_idx = G_MAXUINT;
+	self->zstrm.zalloc = fu_mszip_input_stream_zalloc;
+	self->zstrm.zfree = fu_mszip_input_stream_zfree;
+}
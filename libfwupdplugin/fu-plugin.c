@@ -19,6 +19,7 @@
 #include "fu-config-private.h"
 #include "fu-context-private.h"
 #include "fu-device-private.h"
+#include "fu-digest.h"
 #include "fu-kernel.h"
 #include "fu-path.h"
 #include "fu-plugin-private.h"
@@ -805,9 +806,10 @@ fu_plugin_device_read_firmware(FuPlugin *self,
 	g_autoptr(FuDeviceLocker) locker = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
 	g_autoptr(GBytes) fw = NULL;
-	GChecksumType checksum_types[] = {
-	    G_CHECKSUM_SHA1,
-	    G_CHECKSUM_SHA256,
+	g_autoptr(FuDigest) digest = fu_digest_new(FU_DIGEST_KIND_SHA1 | FU_DIGEST_KIND_SHA256);
+	FuDigestKind digest_kinds[] = {
+	    FU_DIGEST_KIND_SHA1,
+	    FU_DIGEST_KIND_SHA256,
 	};
 
 	locker = fu_device_locker_new(proxy, error);
@@ -831,9 +833,9 @@ fu_plugin_device_read_firmware(FuPlugin *self,
 		g_prefix_error_literal(error, "failed to write firmware: ");
 		return FALSE;
 	}
-	for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
-		g_autofree gchar *hash = NULL;
-		hash = g_compute_checksum_for_bytes(checksum_types[i], fw);
+	fu_digest_update_bytes(digest, fw);
+	for (guint i = 0; i < G_N_ELEMENTS(digest_kinds); i++) {
+		g_autofree gchar *hash = fu_digest_get_string(digest, digest_kinds[i]);
 		fu_device_add_checksum(device, hash);
 	}
 	return fu_device_attach_full(device, progress, error);
@@ -82,6 +82,62 @@ fu_progress_idle_func(void)
 	g_assert_cmpfloat_with_epsilon(fu_progress_get_duration(progress), 0.5f, 0.05);
 }
 
+static void
+fu_progress_rate_limit_func(void)
+{
+	FuProgressHelper helper = {0};
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+
+	g_signal_connect(FU_PROGRESS(progress),
+			 "percentage-changed",
+			 G_CALLBACK(fu_progress_percentage_changed_cb),
+			 &helper);
+	fu_progress_set_rate_limit(progress, 1);
+
+	/* first value is always emitted, but the rest are coalesced */
+	for (guint i = 0; i < 50; i++)
+		fu_progress_set_percentage(progress, i);
+	g_assert_cmpint(helper.updates, ==, 1);
+	g_assert_cmpint(helper.last_percentage, ==, 0);
+	g_assert_cmpint(fu_progress_get_percentage(progress), ==, 49);
+
+	/* pending value is flushed before the status changes */
+	fu_progress_set_status(progress, FWUPD_STATUS_DEVICE_WRITE);
+	g_assert_cmpint(helper.updates, ==, 2);
+	g_assert_cmpint(helper.last_percentage, ==, 49);
+
+	/* final value is never dropped */
+	for (guint i = 50; i <= 100; i++)
+		fu_progress_set_percentage(progress, i);
+	g_assert_cmpint(helper.updates, ==, 3);
+	g_assert_cmpint(helper.last_percentage, ==, 100);
+}
+
+static void
+fu_progress_rate_limit_steps_func(void)
+{
+	FuProgressHelper helper = {0};
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+
+	g_signal_connect(FU_PROGRESS(progress),
+			 "percentage-changed",
+			 G_CALLBACK(fu_progress_percentage_changed_cb),
+			 &helper);
+	fu_progress_set_rate_limit(progress, 1);
+	fu_progress_set_steps(progress, 4);
+	g_assert_cmpint(helper.updates, ==, 1);
+
+	/* pending value is flushed without the main loop running */
+	fu_progress_step_done(progress);
+	g_assert_cmpint(helper.updates, ==, 2);
+	g_assert_cmpint(helper.last_percentage, ==, 25);
+
+	/* and when finishing early */
+	fu_progress_set_percentage(progress, 30);
+	fu_progress_finished(progress);
+	g_assert_cmpint(helper.last_percentage, ==, 100);
+}
+
 static void
 fu_progress_child_func(void)
 {
@@ -342,6 +398,8 @@ main(int argc, char **argv)
 		g_test_add_func("/fwupd/progress/idle", fu_progress_idle_func);
 	}
 	g_test_add_func("/fwupd/progress/scaling", fu_progress_scaling_func);
+	g_test_add_func("/fwupd/progress/rate-limit", fu_progress_rate_limit_func);
+	g_test_add_func("/fwupd/progress/rate-limit-steps", fu_progress_rate_limit_steps_func);
 	g_test_add_func("/fwupd/progress/child", fu_progress_child_func);
 	g_test_add_func("/fwupd/progress/child-finished", fu_progress_child_finished);
 	g_test_add_func("/fwupd/progress/parent-1-step", fu_progress_parent_one_step_proxy_func);
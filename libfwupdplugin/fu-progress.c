@@ -77,6 +77,10 @@ struct _FuProgress {
 	guint step_scaling;
 	FuProgress *parent; /* no-ref */
 	guint sleep_timeout_id;
+	guint rate_limit;	  /* emissions per second, or 0 for unlimited */
+	guint percentage_emitted; /* or G_MAXUINT for none */
+	gint64 percentage_emitted_time;
+	guint percentage_timeout_id;
 };
 
 enum { SIGNAL_PERCENTAGE_CHANGED, SIGNAL_STATUS_CHANGED, SIGNAL_LAST };
@@ -241,6 +245,95 @@ fu_progress_sleep_idle_stop(FuProgress *self)
 	self->sleep_timeout_id = 0;
 }
 
+static void
+fu_progress_percentage_timeout_stop(FuProgress *self)
+{
+	if (self->percentage_timeout_id == 0)
+		return;
+	g_source_remove(self->percentage_timeout_id);
+	self->percentage_timeout_id = 0;
+}
+
+static void
+fu_progress_emit_percentage_changed(FuProgress *self)
+{
+	fu_progress_percentage_timeout_stop(self);
+	if (self->percentage == G_MAXUINT || self->percentage == self->percentage_emitted)
+		return;
+	self->percentage_emitted = self->percentage;
+	self->percentage_emitted_time = g_get_monotonic_time();
+	g_signal_emit(self, signals[SIGNAL_PERCENTAGE_CHANGED], 0, self->percentage);
+}
+
+static gboolean
+fu_progress_percentage_timeout_cb(gpointer user_data)
+{
+	FuProgress *self = FU_PROGRESS(user_data);
+	self->percentage_timeout_id = 0;
+	fu_progress_emit_percentage_changed(self);
+	return G_SOURCE_REMOVE;
+}
+
+/* the main loop may be blocked by a synchronous update, so do not wait for the timeout */
+static void
+fu_progress_flush_percentage_changed(FuProgress *self)
+{
+	if (self->percentage_timeout_id == 0)
+		return;
+	fu_progress_emit_percentage_changed(self);
+}
+
+/* coalesce changes if rate limited, but always emit the first and last values */
+static void
+fu_progress_queue_percentage_changed(FuProgress *self)
+{
+	gint64 interval;
+	gint64 elapsed;
+
+	if (self->rate_limit == 0 || self->percentage == 0 || self->percentage == 100 ||
+	    self->percentage_emitted == G_MAXUINT) {
+		fu_progress_emit_percentage_changed(self);
+		return;
+	}
+	interval = G_USEC_PER_SEC / self->rate_limit;
+	elapsed = g_get_monotonic_time() - self->percentage_emitted_time;
+	if (elapsed >= interval) {
+		fu_progress_emit_percentage_changed(self);
+		return;
+	}
+
+	/* deliver the latest value if nothing else changes before the interval */
+	if (self->percentage_timeout_id == 0) {
+		self->percentage_timeout_id =
+		    g_timeout_add(MAX((interval - elapsed) / 1000, 1),
+				  fu_progress_percentage_timeout_cb,
+				  self);
+	}
+}
+
+/**
+ * fu_progress_set_rate_limit:
+ * @self: a #FuProgress
+ * @rate_limit: maximum number of percentage changes per second, or 0 for unlimited
+ *
+ * Limits how often #FuProgress::percentage-changed is emitted, which is useful when the
+ * percentage is sent over D-Bus. The final 100%% value is always emitted, as is any pending
+ * percentage before the status changes or when a step is done.
+ *
+ * This only affects the signal and not fu_progress_get_percentage(), and should only be used
+ * on the top-level progress object.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_progress_set_rate_limit(FuProgress *self, guint rate_limit)
+{
+	g_return_if_fail(FU_IS_PROGRESS(self));
+	self->rate_limit = rate_limit;
+	if (rate_limit == 0)
+		fu_progress_emit_percentage_changed(self);
+}
+
 /**
  * fu_progress_has_flag:
  * @self: a #FuProgress
@@ -275,8 +368,9 @@ fu_progress_set_status(FuProgress *self, FwupdStatus status)
 	if (self->status == status)
 		return;
 
-	/* save */
+	/* save, ensuring the percentage is not delivered out of order */
 	self->status = status;
+	fu_progress_emit_percentage_changed(self);
 	g_signal_emit(self, signals[SIGNAL_STATUS_CHANGED], 0, status);
 }
 
@@ -391,7 +485,7 @@ fu_progress_set_percentage(FuProgress *self, guint percentage)
 
 	/* save */
 	self->percentage = percentage;
-	g_signal_emit(self, signals[SIGNAL_PERCENTAGE_CHANGED], 0, percentage);
+	fu_progress_queue_percentage_changed(self);
 }
 
 /**
@@ -464,10 +558,12 @@ fu_progress_reset(FuProgress *self)
 
 	/* in case of idle */
 	fu_progress_sleep_idle_stop(self);
+	fu_progress_percentage_timeout_stop(self);
 
 	/* reset values */
 	self->step_now = 0;
 	self->percentage = G_MAXUINT;
+	self->percentage_emitted = G_MAXUINT;
 
 	/* only use the timer if profiling; it's expensive */
 	if (self->profile) {
@@ -740,8 +836,10 @@ fu_progress_finished(FuProgress *self)
 	fu_progress_sleep_idle_stop(self);
 
 	/* is already at 100%? */
-	if (self->step_now == self->children->len)
+	if (self->step_now == self->children->len) {
+		fu_progress_flush_percentage_changed(self);
 		return;
+	}
 
 	/* all done */
 	self->step_now = self->children->len;
@@ -948,6 +1046,7 @@ fu_progress_step_done(FuProgress *self)
 	if (percentage < 0)
 		percentage = fu_progress_discrete_to_percent(self->step_now, self->children->len);
 	fu_progress_set_percentage(self, (guint)percentage);
+	fu_progress_flush_percentage_changed(self);
 
 	/* show any profiling stats */
 	if (self->profile && self->step_now == self->children->len)
@@ -986,7 +1085,8 @@ fu_progress_sleep_idle_cb(gpointer user_data)
 	FuProgress *self = FU_PROGRESS(user_data);
 
 	/* emit directly to avoid canceling the idle timer */
-	g_signal_emit(self, signals[SIGNAL_PERCENTAGE_CHANGED], 0, ++self->percentage);
+	self->percentage++;
+	fu_progress_emit_percentage_changed(self);
 	g_debug("progress on idle @%u%%", self->percentage);
 
 	/* we're done here */
@@ -1123,6 +1223,7 @@ fu_progress_init(FuProgress *self)
 	self->status = FWUPD_STATUS_UNKNOWN;
 	self->step_scaling = 1;
 	self->percentage = G_MAXUINT;
+	self->percentage_emitted = G_MAXUINT;
 	self->timer = g_timer_new();
 	self->timer_child = g_timer_new();
 	self->children = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
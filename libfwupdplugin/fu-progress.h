@@ -49,6 +49,8 @@ fu_progress_set_profile(FuProgress *self, gboolean profile) G_GNUC_NON_NULL(1);
 gboolean
 fu_progress_get_profile(FuProgress *self) G_GNUC_NON_NULL(1);
 void
+fu_progress_set_rate_limit(FuProgress *self, guint rate_limit) G_GNUC_NON_NULL(1);
+void
 fu_progress_reset(FuProgress *self) G_GNUC_NON_NULL(1);
 void
 fu_progress_set_steps(FuProgress *self, guint step_max) G_GNUC_NON_NULL(1);
@@ -83,6 +83,10 @@ struct _FuQuirks {
 	gboolean loaded;
 #ifdef HAVE_SQLITE
 	sqlite3 *db;
+	GMutex db_mutex; /* protects the cached statements */
+	sqlite3_stmt *stmt_lookup;
+	sqlite3_stmt *stmt_lookup_iter;
+	sqlite3_stmt *stmt_lookup_iter_key;
 #endif
 };
 
@@ -90,6 +94,27 @@ G_DEFINE_TYPE(FuQuirks, fu_quirks, G_TYPE_OBJECT)
 
 #ifdef HAVE_SQLITE
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(sqlite3_stmt, sqlite3_finalize);
+
+/* only compiled when first used, and the caller has to reset it when done */
+static sqlite3_stmt *
+fu_quirks_db_prepare_cached(FuQuirks *self, sqlite3_stmt **stmt, const gchar *sql)
+{
+	if (*stmt != NULL)
+		return *stmt;
+	if (sqlite3_prepare_v3(self->db, sql, -1, SQLITE_PREPARE_PERSISTENT, stmt, NULL) !=
+	    SQLITE_OK) {
+		g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
+		return NULL;
+	}
+	return *stmt;
+}
+
+static void
+fu_quirks_db_reset_cached(sqlite3_stmt *stmt)
+{
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
 #endif
 
 static gchar *
@@ -483,23 +508,26 @@ fu_quirks_lookup_by_id(FuQuirks *self, const gchar *guid, const gchar *key)
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
 	if (self->db != NULL && (self->load_flags & FU_QUIRKS_LOAD_FLAG_NO_CACHE) == 0) {
-		g_autoptr(sqlite3_stmt) stmt = NULL;
-		if (sqlite3_prepare_v2(self->db,
-				       "SELECT key, value FROM quirks WHERE guid = ?1 "
-				       "AND key = ?2 LIMIT 1",
-				       -1,
-				       &stmt,
-				       NULL) != SQLITE_OK) {
-			g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
+		const gchar *value = NULL;
+		sqlite3_stmt *stmt;
+		g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&self->db_mutex);
+
+		stmt = fu_quirks_db_prepare_cached(self,
+						   &self->stmt_lookup,
+						   "SELECT key, value FROM quirks WHERE guid = ?1 "
+						   "AND key = ?2 LIMIT 1");
+		if (stmt == NULL)
 			return NULL;
-		}
 		sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
 		sqlite3_bind_text(stmt, 2, key, -1, SQLITE_STATIC);
 		if (sqlite3_step(stmt) == SQLITE_ROW) {
-			const gchar *value = (const gchar *)sqlite3_column_text(stmt, 1);
-			if (value != NULL)
-				return g_intern_string(value);
+			const gchar *tmp = (const gchar *)sqlite3_column_text(stmt, 1);
+			if (tmp != NULL)
+				value = g_intern_string(tmp);
 		}
+		fu_quirks_db_reset_cached(stmt);
+		if (value != NULL)
+			return value;
 	}
 #endif
 
@@ -564,34 +592,45 @@ fu_quirks_lookup_by_id_iter(FuQuirks *self,
 #ifdef HAVE_SQLITE
 	/* this is generated from usb.ids and other static sources */
 	if (self->db != NULL && (self->load_flags & FU_QUIRKS_LOAD_FLAG_NO_CACHE) == 0) {
-		g_autoptr(sqlite3_stmt) stmt = NULL;
+		sqlite3_stmt *stmt;
+		g_autoptr(GPtrArray) kvs = g_ptr_array_new_with_free_func(g_free);
+
+		/* copy the results so that @iter_cb can do other lookups */
+		g_mutex_lock(&self->db_mutex);
 		if (key == NULL) {
-			if (sqlite3_prepare_v2(self->db,
-					       "SELECT key, value FROM quirks WHERE guid = ?1",
-					       -1,
-					       &stmt,
-					       NULL) != SQLITE_OK) {
-				g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
+			stmt = fu_quirks_db_prepare_cached(
+			    self,
+			    &self->stmt_lookup_iter,
+			    "SELECT key, value FROM quirks WHERE guid = ?1");
+			if (stmt == NULL) {
+				g_mutex_unlock(&self->db_mutex);
 				return FALSE;
 			}
 			sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
 		} else {
-			if (sqlite3_prepare_v2(self->db,
-					       "SELECT key, value FROM quirks WHERE guid = ?1 "
-					       "AND key = ?2",
-					       -1,
-					       &stmt,
-					       NULL) != SQLITE_OK) {
-				g_warning("failed to prepare SQL: %s", sqlite3_errmsg(self->db));
+			stmt = fu_quirks_db_prepare_cached(self,
+							   &self->stmt_lookup_iter_key,
+							   "SELECT key, value FROM quirks WHERE guid = ?1 "
+							   "AND key = ?2");
+			if (stmt == NULL) {
+				g_mutex_unlock(&self->db_mutex);
 				return FALSE;
 			}
 			sqlite3_bind_text(stmt, 1, guid, -1, SQLITE_STATIC);
 			sqlite3_bind_text(stmt, 2, key, -1, SQLITE_STATIC);
 		}
 		while (sqlite3_step(stmt) == SQLITE_ROW) {
-			const gchar *key_tmp = (const gchar *)sqlite3_column_text(stmt, 0);
-			const gchar *value = (const gchar *)sqlite3_column_text(stmt, 1);
-			iter_cb(self, key_tmp, value, FU_CONTEXT_QUIRK_SOURCE_DB, user_data);
+			g_ptr_array_add(kvs, g_strdup((const gchar *)sqlite3_column_text(stmt, 0)));
+			g_ptr_array_add(kvs, g_strdup((const gchar *)sqlite3_column_text(stmt, 1)));
+		}
+		fu_quirks_db_reset_cached(stmt);
+		g_mutex_unlock(&self->db_mutex);
+		for (guint i = 0; i + 1 < kvs->len; i += 2) {
+			iter_cb(self,
+				g_ptr_array_index(kvs, i),
+				g_ptr_array_index(kvs, i + 1),
+				FU_CONTEXT_QUIRK_SOURCE_DB,
+				user_data);
 		}
 	}
 #endif
@@ -1110,6 +1149,9 @@ fu_quirks_init(FuQuirks *self)
 {
 	self->possible_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 	self->invalid_keys = g_ptr_array_new_with_free_func(g_free);
+#ifdef HAVE_SQLITE
+	g_mutex_init(&self->db_mutex);
+#endif
 
 	/* built in */
 	fu_quirks_add_possible_key(self, FU_QUIRKS_BRANCH);
@@ -1167,8 +1209,12 @@ fu_quirks_finalize(GObject *obj)
 	if (self->silo != NULL)
 		g_object_unref(self->silo);
 #ifdef HAVE_SQLITE
+	g_clear_pointer(&self->stmt_lookup, sqlite3_finalize);
+	g_clear_pointer(&self->stmt_lookup_iter, sqlite3_finalize);
+	g_clear_pointer(&self->stmt_lookup_iter_key, sqlite3_finalize);
 	if (self->db != NULL)
 		sqlite3_close(self->db);
+	g_mutex_clear(&self->db_mutex);
 #endif
 	g_hash_table_unref(self->possible_keys);
 	g_ptr_array_unref(self->invalid_keys);
@@ -7,7 +7,7 @@ enum FuSelfTestRevision {
     All	= 0xF_F,
 }
 
-#[derive(New, Validate, Parse, ToString, Default)]
+#[derive(New, Validate, Parse, View, ViewStream, ToString, Default)]
 #[repr(C, packed)]
 struct FuStructSelfTest {
     signature: u32be == 0x1234_5678,
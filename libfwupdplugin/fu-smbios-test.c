@@ -112,6 +112,74 @@ fu_smbios3_func(void)
 	g_assert_cmpstr(str, ==, "Dell Inc.");
 }
 
+static void
+fu_smbios_index_func(void)
+{
+	guint val;
+	const gchar *str;
+	g_autoptr(FuFirmware) smbios = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) blobs = NULL;
+
+	g_type_ensure(FU_TYPE_SMBIOS);
+	smbios = fu_firmware_new_from_xml("<firmware gtype=\"FuSmbios\">\n"
+					  "  <item>\n"
+					  "    <type>0x11</type>\n"
+					  "    <buf>110400010002</buf>\n"
+					  "    <string>DIMM A</string>\n"
+					  "  </item>\n"
+					  "  <item>\n"
+					  "    <type>0x01</type>\n"
+					  "    <buf>0104000101</buf>\n"
+					  "    <string>fwupd</string>\n"
+					  "  </item>\n"
+					  "  <item>\n"
+					  "    <type>0x11</type>\n"
+					  "    <buf>1105000200020301</buf>\n"
+					  "    <string>DIMM B</string>\n"
+					  "  </item>\n"
+					  "</firmware>\n",
+					  &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(smbios);
+
+	/* first structure of the type */
+	str = fu_smbios_get_string(FU_SMBIOS(smbios),
+				   FU_SMBIOS_STRUCTURE_TYPE_SYSTEM,
+				   FU_SMBIOS_STRUCTURE_LENGTH_ANY,
+				   0x04,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(str, ==, "fwupd");
+	str = fu_smbios_get_string(FU_SMBIOS(smbios),
+				   0x11,
+				   FU_SMBIOS_STRUCTURE_LENGTH_ANY,
+				   0x03,
+				   &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(str, ==, "DIMM A");
+
+	/* filtered by length */
+	val = fu_smbios_get_integer(FU_SMBIOS(smbios), 0x11, 0x08, 0x06, &error);
+	g_assert_no_error(error);
+	g_assert_cmpint(val, ==, 0x03);
+
+	/* all structures of the type */
+	blobs = fu_smbios_get_data(FU_SMBIOS(smbios), 0x11, FU_SMBIOS_STRUCTURE_LENGTH_ANY, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(blobs);
+	g_assert_cmpint(blobs->len, ==, 2);
+
+	/* not present */
+	val = fu_smbios_get_integer(FU_SMBIOS(smbios),
+				    0x09,
+				    FU_SMBIOS_STRUCTURE_LENGTH_ANY,
+				    0x0,
+				    &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_cmpint(val, ==, G_MAXUINT);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -119,5 +187,6 @@ main(int argc, char **argv)
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/smbios", fu_smbios_func);
 	g_test_add_func("/fwupd/smbios3", fu_smbios3_func);
+	g_test_add_func("/fwupd/smbios/index", fu_smbios_index_func);
 	return g_test_run();
 }
@@ -40,6 +40,7 @@ struct _FuSmbios {
 	FuPathStore *pstore;
 	guint32 structure_table_len;
 	GPtrArray *items;
+	GPtrArray *items_by_type[G_MAXUINT8 + 1]; /* nullable, element-type FuSmbiosItem, noref */
 };
 
 typedef struct {
@@ -70,13 +71,25 @@ fu_smbios_item_free(FuSmbiosItem *item)
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuSmbiosItem, fu_smbios_item_free)
 
+/* takes ownership of @item */
+static void
+fu_smbios_add_item(FuSmbios *self, FuSmbiosItem *item)
+{
+	if (self->items_by_type[item->type] == NULL)
+		self->items_by_type[item->type] = g_ptr_array_new();
+	g_ptr_array_add(self->items_by_type[item->type], item);
+	g_ptr_array_add(self->items, item);
+}
+
 static FuSmbiosItem *
 fu_smbios_get_item_for_type_length(FuSmbios *self, guint8 type, guint8 length)
 {
-	for (guint i = 0; i < self->items->len; i++) {
-		FuSmbiosItem *item = g_ptr_array_index(self->items, i);
-		if (item->type != type)
-			continue;
+	GPtrArray *items = self->items_by_type[type];
+
+	if (items == NULL)
+		return NULL;
+	for (guint i = 0; i < items->len; i++) {
+		FuSmbiosItem *item = g_ptr_array_index(items, i);
 		if (length != FU_SMBIOS_STRUCTURE_LENGTH_ANY && length != item->buf->len) {
 			g_debug("filtering SMBIOS structure by length: 0x%x != 0x%x",
 				length,
@@ -150,7 +163,7 @@ fu_smbios_setup_from_data(FuSmbios *self, const guint8 *buf, gsize bufsz, GError
 		}
 
 		/* success */
-		g_ptr_array_add(self->items, g_steal_pointer(&item));
+		fu_smbios_add_item(self, g_steal_pointer(&item));
 	}
 
 	/* this has to exist */
@@ -540,7 +553,7 @@ fu_smbios_build_item(FuSmbios *self, XbNode *n, GError **error)
 	}
 
 	/* success */
-	g_ptr_array_add(self->items, g_steal_pointer(&item));
+	fu_smbios_add_item(self, g_steal_pointer(&item));
 	return TRUE;
 }
 
@@ -580,15 +593,15 @@ fu_smbios_build(FuFirmware *firmware, XbNode *n, GError **error)
 GPtrArray *
 fu_smbios_get_data(FuSmbios *self, guint8 type, guint8 length, GError **error)
 {
+	GPtrArray *items;
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_bytes_unref);
 
 	g_return_val_if_fail(FU_IS_SMBIOS(self), NULL);
 	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
 
-	for (guint i = 0; i < self->items->len; i++) {
-		FuSmbiosItem *item = g_ptr_array_index(self->items, i);
-		if (item->type != type)
-			continue;
+	items = self->items_by_type[type];
+	for (guint i = 0; items != NULL && i < items->len; i++) {
+		FuSmbiosItem *item = g_ptr_array_index(items, i);
 		if (length != FU_SMBIOS_STRUCTURE_LENGTH_ANY && length != item->buf->len)
 			continue;
 		if (item->buf->len == 0)
@@ -724,6 +737,10 @@ fu_smbios_finalize(GObject *object)
 	FuSmbios *self = FU_SMBIOS(object);
 	if (self->pstore != NULL)
 		g_object_unref(self->pstore);
+	for (guint i = 0; i < G_N_ELEMENTS(self->items_by_type); i++) {
+		if (self->items_by_type[i] != NULL)
+			g_ptr_array_unref(self->items_by_type[i]);
+	}
 	g_ptr_array_unref(self->items);
 	G_OBJECT_CLASS(fu_smbios_parent_class)->finalize(object);
 }
@@ -9,6 +9,7 @@
 #include <fwupdplugin.h>
 
 #include "fu-self-test-struct.h"
+#include "fu-struct-trace-private.h"
 #include "fu-test.h"
 
 static void
@@ -156,6 +157,82 @@ fu_plugin_struct_func(void)
 	g_assert_false(ret);
 }
 
+static void
+fu_plugin_struct_view_func(void)
+{
+	const FuStructSelfTest *st_view;
+	FuStructSelfTestView view = {0};
+	g_autoptr(FuStructSelfTest) st = fu_struct_self_test_new();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* borrowed from the buffer */
+	fu_struct_self_test_set_oem_revision(st, 0x1234);
+	st_view = fu_struct_self_test_view(&view, st->buf->data, st->buf->len, 0x0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(st_view);
+	g_assert_true(st_view->buf->data == st->buf->data);
+	g_assert_cmpint(fu_struct_self_test_get_oem_revision(st_view), ==, 0x1234);
+
+	/* too small */
+	st_view = fu_struct_self_test_view(&view, st->buf->data, st->buf->len - 1, 0x0, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_null(st_view);
+	g_clear_error(&error);
+
+	/* copied into the view storage */
+	stream = g_memory_input_stream_new_from_data(st->buf->data, st->buf->len, NULL);
+	st_view = fu_struct_self_test_view_stream(&view, stream, 0x0, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(st_view);
+	g_assert_true(st_view->buf->data == view.data);
+	g_assert_cmpint(fu_struct_self_test_get_oem_revision(st_view), ==, 0x1234);
+
+	/* truncated stream */
+	st_view = fu_struct_self_test_view_stream(&view, stream, 0x1, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_null(st_view);
+	g_clear_error(&error);
+
+	/* failing signature */
+	st->buf->data[0] = 0xFF;
+	st_view = fu_struct_self_test_view(&view, st->buf->data, st->buf->len, 0x0, &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_INVALID_DATA);
+	g_assert_null(st_view);
+}
+
+static void
+fu_plugin_struct_trace_func(void)
+{
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuStructSelfTest) st = fu_struct_self_test_new();
+	g_autoptr(GError) error = NULL;
+
+	/* only matching structures are converted to a string when parsed */
+	fu_struct_trace_set_filter("FuStructCabData,FuStructSelfTest*");
+	g_assert_true(fu_struct_trace_enabled("FuStructSelfTestWrapped"));
+	g_assert_false(fu_struct_trace_enabled("FuStructCabHeader"));
+	fu_struct_trace_set_filter(NULL);
+	g_assert_false(fu_struct_trace_enabled("FuStructSelfTest"));
+
+	/* the raw data is recorded, and only formatted when required */
+	g_log_set_debug_enabled(TRUE);
+	fu_struct_trace_clear();
+	g_assert_null(fu_struct_trace_to_string());
+	fu_struct_self_test_set_oem_revision(st, 0x1234);
+	for (guint i = 0; i < 100; i++) {
+		g_autoptr(FuStructSelfTest) st_tmp =
+		    fu_struct_self_test_parse(st->buf->data, st->buf->len, 0x0, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(st_tmp);
+	}
+	g_log_set_debug_enabled(FALSE);
+	str = fu_struct_trace_to_string();
+	g_assert_nonnull(str);
+	g_assert_nonnull(g_strstr_len(str, -1, "oem_revision: 0x1234"));
+	fu_struct_trace_clear();
+}
+
 static void
 fu_plugin_struct_wrapped_func(void)
 {
@@ -241,5 +318,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/struct/bits", fu_plugin_struct_bits_func);
 	g_test_add_func("/fwupd/struct/list", fu_plugin_struct_list_func);
 	g_test_add_func("/fwupd/struct/wrapped", fu_plugin_struct_wrapped_func);
+	g_test_add_func("/fwupd/struct/view", fu_plugin_struct_view_func);
+	g_test_add_func("/fwupd/struct/trace", fu_plugin_struct_trace_func);
 	return g_test_run();
 }
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+/**
+ * FuStructTraceToStringFunc:
+ * @buf: the raw structure data
+ * @bufsz: size of @buf
+ *
+ * Formats a previously parsed structure for display.
+ *
+ * Returns: (transfer full): a string
+ **/
+typedef gchar *(*FuStructTraceToStringFunc)(const guint8 *buf, gsize bufsz);
+
+gboolean
+fu_struct_trace_enabled(const gchar *name) G_GNUC_NON_NULL(1);
+void
+fu_struct_trace_set_filter(const gchar *filter);
+void
+fu_struct_trace_push(const gchar *name,
+		     FuStructTraceToStringFunc func,
+		     const guint8 *buf,
+		     gsize bufsz) G_GNUC_NON_NULL(1, 3);
+gchar *
+fu_struct_trace_to_string(void);
+void
+fu_struct_trace_dump(void);
+void
+fu_struct_trace_clear(void);
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuStruct"
+
+#include "config.h"
+
+#include "fu-byte-array.h"
+#include "fu-struct-trace-private.h"
+
+/* number of recently parsed structures to keep */
+#define FU_STRUCT_TRACE_RING_SIZE 32
+
+typedef struct {
+	const gchar *name;
+	FuStructTraceToStringFunc func;
+	GByteArray *buf;
+} FuTraceItem;
+
+static GMutex trace_mutex;
+static FuTraceItem trace_ring[FU_STRUCT_TRACE_RING_SIZE];
+static guint trace_ring_idx;
+static guint trace_ring_len;
+static gchar **trace_filter;
+
+static void
+fu_struct_trace_filter_ensure(void)
+{
+	static gsize trace_filter_setup = 0;
+	if (g_once_init_enter(&trace_filter_setup)) {
+		const gchar *tmp = g_getenv("FWUPD_STRUCT_VERBOSE");
+		if (tmp != NULL && tmp[0] != '\0')
+			trace_filter = g_strsplit(tmp, ",", -1);
+		g_once_init_leave(&trace_filter_setup, 1);
+	}
+}
+
+/**
+ * fu_struct_trace_set_filter:
+ * @filter: (nullable): comma separated structure names or globs, e.g. `FuStructCab*`
+ *
+ * Overrides the structures that are logged when parsed, which is normally set using
+ * the `FWUPD_STRUCT_VERBOSE` environment variable.
+ *
+ * This should only be used in self tests, as it is not threadsafe.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_struct_trace_set_filter(const gchar *filter)
+{
+	fu_struct_trace_filter_ensure();
+	g_strfreev(trace_filter);
+	trace_filter = NULL;
+	if (filter != NULL && filter[0] != '\0')
+		trace_filter = g_strsplit(filter, ",", -1);
+}
+
+/**
+ * fu_struct_trace_enabled:
+ * @name: a structure name, e.g. `FuStructCabData`
+ *
+ * Gets if the structure should be logged when parsed. This is deliberately not tied to
+ * g_log_get_debug_enabled() as converting every parsed structure to a string is slow.
+ *
+ * Returns: %TRUE if the structure name matches `FWUPD_STRUCT_VERBOSE`
+ *
+ * Since: 2.1.2
+ **/
+gboolean
+fu_struct_trace_enabled(const gchar *name)
+{
+	g_return_val_if_fail(name != NULL, FALSE);
+
+	fu_struct_trace_filter_ensure();
+	if (trace_filter == NULL)
+		return FALSE;
+	for (guint i = 0; trace_filter[i] != NULL; i++) {
+		if (g_pattern_match_simple(trace_filter[i], name))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * fu_struct_trace_push:
+ * @name: a static structure name, e.g. `FuStructCabData`
+ * @func: (scope forever): a function to format the structure
+ * @buf: the raw structure data
+ * @bufsz: size of @buf
+ *
+ * Records a parsed structure into a fixed-size ring buffer. The data is only copied, and
+ * is not formatted until fu_struct_trace_to_string() is called.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_struct_trace_push(const gchar *name,
+		     FuStructTraceToStringFunc func,
+		     const guint8 *buf,
+		     gsize bufsz)
+{
+	FuTraceItem *item;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&trace_mutex);
+
+	g_return_if_fail(name != NULL);
+	g_return_if_fail(buf != NULL);
+
+	item = &trace_ring[trace_ring_idx];
+	if (item->buf == NULL)
+		item->buf = g_byte_array_sized_new(bufsz);
+	g_byte_array_set_size(item->buf, 0);
+	g_byte_array_append(item->buf, buf, bufsz);
+	item->name = name;
+	item->func = func;
+	trace_ring_idx = (trace_ring_idx + 1) % FU_STRUCT_TRACE_RING_SIZE;
+	trace_ring_len = MIN(trace_ring_len + 1, FU_STRUCT_TRACE_RING_SIZE);
+}
+
+/**
+ * fu_struct_trace_to_string:
+ *
+ * Formats the most recently parsed structures, oldest first.
+ *
+ * Returns: (transfer full): a string, or %NULL if no structures have been recorded
+ *
+ * Since: 2.1.2
+ **/
+gchar *
+fu_struct_trace_to_string(void)
+{
+	g_autoptr(GString) str = g_string_new(NULL);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&trace_mutex);
+
+	for (guint i = 0; i < trace_ring_len; i++) {
+		guint idx = (trace_ring_idx + FU_STRUCT_TRACE_RING_SIZE - trace_ring_len + i) %
+			    FU_STRUCT_TRACE_RING_SIZE;
+		FuTraceItem *item = &trace_ring[idx];
+		if (item->func != NULL) {
+			g_autofree gchar *tmp = item->func(item->buf->data, item->buf->len);
+			g_string_append(str, tmp);
+		} else {
+			g_autofree gchar *tmp = fu_byte_array_to_string(item->buf);
+			g_string_append_printf(str, "%s:\n  raw: %s", item->name, tmp);
+		}
+		if (!g_str_has_suffix(str->str, "\n"))
+			g_string_append(str, "\n");
+	}
+	if (str->len == 0)
+		return NULL;
+	return g_string_free(g_steal_pointer(&str), FALSE);
+}
+
+/**
+ * fu_struct_trace_dump:
+ *
+ * Logs the most recently parsed structures, typically used after failing to parse firmware.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_struct_trace_dump(void)
+{
+	g_autofree gchar *str = NULL;
+
+	/* nothing is recorded unless debugging */
+	if (!g_log_get_debug_enabled())
+		return;
+	str = fu_struct_trace_to_string();
+	if (str == NULL)
+		return;
+	g_debug("recently parsed structures:");
+	g_debug("%s", str);
+}
+
+/**
+ * fu_struct_trace_clear:
+ *
+ * Clears the ring buffer of recently parsed structures.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_struct_trace_clear(void)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new(&trace_mutex);
+	trace_ring_idx = 0;
+	trace_ring_len = 0;
+}
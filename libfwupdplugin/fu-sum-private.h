@@ -0,0 +1,21 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "fu-sum.h"
+
+#define FU_SUM_LANES 4
+
+void
+fu_sum_lanes(const guint8 *buf, gsize bufsz, gsize offset, guint64 lanes[FU_SUM_LANES])
+    G_GNUC_NON_NULL(4);
+guint16
+fu_sum_lanes_to_sum16w(const guint64 lanes[FU_SUM_LANES], FuEndianType endian) G_GNUC_NON_NULL(1);
+guint32
+fu_sum_lanes_to_sum32w(const guint64 lanes[FU_SUM_LANES], FuEndianType endian) G_GNUC_NON_NULL(1);
+guint64
+fu_sum_lanes_to_sum(const guint64 lanes[FU_SUM_LANES]) G_GNUC_NON_NULL(1);
@@ -8,8 +8,133 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "fu-mem-private.h"
-#include "fu-sum.h"
+#include "fu-sum-private.h"
+
+/* every 32-bit half of the accumulator can absorb this many bytes of 0xFF */
+#define FU_SUM_LANES_BLOCK_MAX 0x10000
+
+/**
+ * fu_sum_lanes:
+ * @buf: memory buffer
+ * @bufsz: size of @buf
+ * @offset: offset of @buf in the complete image
+ * @lanes: (array fixed-size=4): accumulated byte sums
+ *
+ * Adds each byte of @buf into the lane for its position modulo 4, processing eight bytes at a
+ * time. Using @offset allows the data to be split into any number of chunks, and the lanes can
+ * then be combined into any of the byte, word or dword sums.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_sum_lanes(const guint8 *buf, gsize bufsz, gsize offset, guint64 lanes[FU_SUM_LANES])
+{
+	gsize i = 0;
+
+	/* each 32-bit half of the accumulator holds one byte position */
+	while (bufsz - i >= sizeof(guint64)) {
+		guint64 acc[FU_SUM_LANES] = {0};
+		gsize blocksz = MIN((bufsz - i) / sizeof(guint64), FU_SUM_LANES_BLOCK_MAX);
+		for (gsize j = 0; j < blocksz; j++) {
+			guint64 val;
+			memcpy(&val, buf + i, sizeof(val)); /* nocheck:blocked */
+			acc[0] += val & 0x000000FF000000FFull;
+			acc[1] += (val >> 8) & 0x000000FF000000FFull;
+			acc[2] += (val >> 16) & 0x000000FF000000FFull;
+			acc[3] += (val >> 24) & 0x000000FF000000FFull;
+			i += sizeof(guint64);
+		}
+		for (guint j = 0; j < FU_SUM_LANES; j++) {
+			guint pos = G_BYTE_ORDER == G_LITTLE_ENDIAN ? j : FU_SUM_LANES - 1 - j;
+			guint64 tmp = (acc[j] & G_MAXUINT32) + (acc[j] >> 32);
+			lanes[(offset + pos) % FU_SUM_LANES] += tmp;
+		}
+	}
+
+	/* remainder */
+	for (; i < bufsz; i++)
+		lanes[(offset + i) % FU_SUM_LANES] += buf[i];
+}
+
+/**
+ * fu_sum_lanes_to_sum:
+ * @lanes: (array fixed-size=4): accumulated byte sums
+ *
+ * Returns the arithmetic sum of all bytes.
+ *
+ * Returns: sum value
+ *
+ * Since: 2.1.2
+ **/
+guint64
+fu_sum_lanes_to_sum(const guint64 lanes[FU_SUM_LANES])
+{
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static gboolean
+fu_sum_endian_is_big(FuEndianType endian)
+{
+	if (endian == G_BIG_ENDIAN)
+		return TRUE;
+	if (endian == G_LITTLE_ENDIAN)
+		return FALSE;
+	return G_BYTE_ORDER == G_BIG_ENDIAN;
+}
+
+/**
+ * fu_sum_lanes_to_sum16w:
+ * @lanes: (array fixed-size=4): accumulated byte sums
+ * @endian: an endian type, e.g. %G_LITTLE_ENDIAN
+ *
+ * Returns the arithmetic sum of all bytes, as if added one word at a time.
+ *
+ * Returns: sum value
+ *
+ * Since: 2.1.2
+ **/
+guint16
+fu_sum_lanes_to_sum16w(const guint64 lanes[FU_SUM_LANES], FuEndianType endian)
+{
+	guint64 even = lanes[0] + lanes[2];
+	guint64 odd = lanes[1] + lanes[3];
+	if (fu_sum_endian_is_big(endian))
+		return (guint16)(odd + (even << 8));
+	return (guint16)(even + (odd << 8));
+}
+
+/**
+ * fu_sum_lanes_to_sum32w:
+ * @lanes: (array fixed-size=4): accumulated byte sums
+ * @endian: an endian type, e.g. %G_LITTLE_ENDIAN
+ *
+ * Returns the arithmetic sum of all bytes, as if added one dword at a time.
+ *
+ * Returns: sum value
+ *
+ * Since: 2.1.2
+ **/
+guint32
+fu_sum_lanes_to_sum32w(const guint64 lanes[FU_SUM_LANES], FuEndianType endian)
+{
+	guint64 tmp = 0;
+	for (guint i = 0; i < FU_SUM_LANES; i++) {
+		guint shift = fu_sum_endian_is_big(endian) ? 8 * (FU_SUM_LANES - 1 - i) : 8 * i;
+		tmp += lanes[i] << shift;
+	}
+	return (guint32)tmp;
+}
+
+static guint64
+fu_sum_bytes_internal(const guint8 *buf, gsize bufsz)
+{
+	guint64 lanes[FU_SUM_LANES] = {0};
+	fu_sum_lanes(buf, bufsz, 0, lanes);
+	return fu_sum_lanes_to_sum(lanes);
+}
 
 /**
  * fu_sum8:
@@ -25,11 +150,8 @@
 guint8
 fu_sum8(const guint8 *buf, gsize bufsz)
 {
-	guint8 checksum = 0;
 	g_return_val_if_fail(buf != NULL || bufsz == 0, G_MAXUINT8);
-	for (gsize i = 0; i < bufsz; i++)
-		checksum += buf[i];
-	return checksum;
+	return (guint8)fu_sum_bytes_internal(buf, bufsz);
 }
 
 /**
@@ -97,11 +219,8 @@ fu_sum8_bytes(GBytes *blob)
 guint16
 fu_sum16(const guint8 *buf, gsize bufsz)
 {
-	guint16 checksum = 0;
 	g_return_val_if_fail(buf != NULL || bufsz == 0, G_MAXUINT16);
-	for (gsize i = 0; i < bufsz; i++)
-		checksum += buf[i];
-	return checksum;
+	return (guint16)fu_sum_bytes_internal(buf, bufsz);
 }
 
 /**
@@ -169,12 +288,11 @@ fu_sum16_bytes(GBytes *blob)
 guint16
 fu_sum16w(const guint8 *buf, gsize bufsz, FuEndianType endian)
 {
-	guint16 checksum = 0;
+	guint64 lanes[FU_SUM_LANES] = {0};
 	g_return_val_if_fail(buf != NULL || bufsz == 0, G_MAXUINT16);
 	g_return_val_if_fail(bufsz % 2 == 0, G_MAXUINT16);
-	for (gsize i = 0; i < bufsz; i += 2)
-		checksum += fu_memread_uint16(&buf[i], endian);
-	return checksum;
+	fu_sum_lanes(buf, bufsz, 0, lanes);
+	return fu_sum_lanes_to_sum16w(lanes, endian);
 }
 
 /**
@@ -210,11 +328,8 @@ fu_sum16w_bytes(GBytes *blob, FuEndianType endian)
 guint32
 fu_sum32(const guint8 *buf, gsize bufsz)
 {
-	guint32 checksum = 0;
 	g_return_val_if_fail(buf != NULL || bufsz == 0, G_MAXUINT32);
-	for (gsize i = 0; i < bufsz; i++)
-		checksum += buf[i];
-	return checksum;
+	return (guint32)fu_sum_bytes_internal(buf, bufsz);
 }
 
 /**
@@ -250,12 +365,11 @@ fu_sum32_bytes(GBytes *blob)
 guint32
 fu_sum32w(const guint8 *buf, gsize bufsz, FuEndianType endian)
 {
-	guint32 checksum = 0;
+	guint64 lanes[FU_SUM_LANES] = {0};
 	g_return_val_if_fail(buf != NULL || bufsz == 0, G_MAXUINT32);
 	g_return_val_if_fail(bufsz % 4 == 0, G_MAXUINT32);
-	for (gsize i = 0; i < bufsz; i += 4)
-		checksum += fu_memread_uint32(&buf[i], endian);
-	return checksum;
+	fu_sum_lanes(buf, bufsz, 0, lanes);
+	return fu_sum_lanes_to_sum32w(lanes, endian);
 }
 
 /**
@@ -14,3 +14,6 @@
 #define FU_TPM_DIGEST_SIZE_SHA384  48
 #define FU_TPM_DIGEST_SIZE_SHA512  64
 #define FU_TPM_DIGEST_SIZE_SM3_256 32
+
+/* number of PCRs in a TPM bank */
+#define FU_TPM_PCR_COUNT 24
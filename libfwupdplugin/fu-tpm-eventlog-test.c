@@ -50,10 +50,153 @@ fu_tpm_eventlog_func(void)
 	g_assert_cmpstr(csum_sha1, ==, "2942632a0231d481bf40564515998dd72c01c118");
 }
 
+/* PCR = hash(PCR || measurement), written out separately from the replay in FuTpmEventlog */
+static void
+fu_tpm_eventlog_test_extend(GChecksumType checksum_type,
+			    guint8 *digest,
+			    gsize digestsz,
+			    const guint8 *buf,
+			    gsize bufsz)
+{
+	g_autoptr(GChecksum) csum = g_checksum_new(checksum_type);
+	g_checksum_update(csum, digest, digestsz);
+	g_checksum_update(csum, buf, bufsz);
+	g_checksum_get_digest(csum, digest, &digestsz);
+}
+
+/* synthetic log measuring into PCR0-7, optionally also extending the expected PCR values */
+static FuTpmEventlog *
+fu_tpm_eventlog_test_new_synthetic(guint n_events, guint8 (*pcr_sha1)[20], guint8 (*pcr_sha256)[32])
+{
+	g_autoptr(FuTpmEventlog) log = fu_tpm_eventlog_v2_new();
+
+	for (guint i = 0; i < n_events; i++) {
+		gboolean ret;
+		g_autoptr(FuTpmEventlogItem) item = fu_tpm_eventlog_item_new();
+		g_autoptr(GBytes) csum_sha1 = NULL;
+		g_autoptr(GBytes) csum_sha256 = NULL;
+		g_autoptr(GError) error = NULL;
+		guint8 buf_sha1[20] = {0x0};
+		guint8 buf_sha256[32] = {0x0};
+		gsize buf_sha1sz = sizeof(buf_sha1);
+		gsize buf_sha256sz = sizeof(buf_sha256);
+		g_autoptr(GChecksum) sha1 = g_checksum_new(G_CHECKSUM_SHA1);
+		g_autoptr(GChecksum) sha256 = g_checksum_new(G_CHECKSUM_SHA256);
+
+		g_checksum_update(sha1, (const guchar *)&i, sizeof(i));
+		g_checksum_get_digest(sha1, buf_sha1, &buf_sha1sz);
+		g_checksum_update(sha256, (const guchar *)&i, sizeof(i));
+		g_checksum_get_digest(sha256, buf_sha256, &buf_sha256sz);
+		if (pcr_sha1 != NULL) {
+			fu_tpm_eventlog_test_extend(G_CHECKSUM_SHA1,
+						    pcr_sha1[i % 8],
+						    sizeof(pcr_sha1[i % 8]),
+						    buf_sha1,
+						    buf_sha1sz);
+		}
+		if (pcr_sha256 != NULL) {
+			fu_tpm_eventlog_test_extend(G_CHECKSUM_SHA256,
+						    pcr_sha256[i % 8],
+						    sizeof(pcr_sha256[i % 8]),
+						    buf_sha256,
+						    buf_sha256sz);
+		}
+		csum_sha1 = g_bytes_new(buf_sha1, buf_sha1sz);
+		csum_sha256 = g_bytes_new(buf_sha256, buf_sha256sz);
+		fu_tpm_eventlog_item_set_kind(item, FU_TPM_EVENTLOG_ITEM_KIND_EFI_ACTION);
+		fu_tpm_eventlog_item_set_pcr(item, i % 8);
+		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA1, csum_sha1);
+		fu_tpm_eventlog_item_add_checksum(item, FU_TPM_ALG_SHA256, csum_sha256);
+		ret = fu_firmware_add_image(FU_FIRMWARE(log), FU_FIRMWARE(item), &error);
+		g_assert_no_error(error);
+		g_assert_true(ret);
+	}
+	return g_steal_pointer(&log);
+}
+
+static void
+fu_tpm_eventlog_all_func(void)
+{
+	guint8 pcr_sha1[8][20] = {{0x0}};
+	guint8 pcr_sha256[8][32] = {{0x0}};
+	g_autoptr(FuTpmEventlog) log = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) pcrs_all = NULL;
+
+	log = fu_tpm_eventlog_test_new_synthetic(800, pcr_sha1, pcr_sha256);
+
+	/* replay once */
+	pcrs_all = fu_tpm_eventlog_calc_checksums_all(log, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(pcrs_all);
+	g_assert_cmpint(pcrs_all->len, ==, 24);
+	for (guint i = 0; i < 8; i++) {
+		GPtrArray *pcrs = g_ptr_array_index(pcrs_all, i);
+		g_autoptr(GBytes) blob_sha1 = g_bytes_new_static(pcr_sha1[i], sizeof(pcr_sha1[i]));
+		g_autoptr(GBytes) blob_sha256 =
+		    g_bytes_new_static(pcr_sha256[i], sizeof(pcr_sha256[i]));
+		g_autofree gchar *str_sha1 = fu_bytes_to_string(blob_sha1);
+		g_autofree gchar *str_sha256 = fu_bytes_to_string(blob_sha256);
+		g_assert_cmpstr(fwupd_checksum_get_by_kind(pcrs, G_CHECKSUM_SHA1), ==, str_sha1);
+		g_assert_cmpstr(fwupd_checksum_get_by_kind(pcrs, G_CHECKSUM_SHA256),
+				==,
+				str_sha256);
+	}
+
+	/* replay for each PCR */
+	for (guint8 i = 0; i < 8; i++) {
+		GPtrArray *pcrs = g_ptr_array_index(pcrs_all, i);
+		g_autoptr(GPtrArray) pcrs_tmp = fu_tpm_eventlog_calc_checksums(log, i, &error);
+		g_assert_no_error(error);
+		g_assert_nonnull(pcrs_tmp);
+		g_assert_cmpint(pcrs->len, ==, 2);
+		g_assert_cmpint(pcrs_tmp->len, ==, 2);
+		for (guint j = 0; j < pcrs->len; j++) {
+			g_assert_cmpstr(g_ptr_array_index(pcrs, j),
+					==,
+					g_ptr_array_index(pcrs_tmp, j));
+		}
+	}
+
+	/* nothing measured */
+	for (guint i = 8; i < pcrs_all->len; i++) {
+		GPtrArray *pcrs = g_ptr_array_index(pcrs_all, i);
+		g_assert_cmpint(pcrs->len, ==, 0);
+	}
+}
+
+static void
+fu_tpm_eventlog_replay_perf_func(void)
+{
+	g_autoptr(FuTpmEventlog) log = fu_tpm_eventlog_test_new_synthetic(10000, NULL, NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) pcrs_all = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
+
+	/* as fwupdtool get-tpm-eventlog does now */
+	pcrs_all = fu_tpm_eventlog_calc_checksums_all(log, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(pcrs_all);
+	g_test_message("single pass replay of 10000 events: %.1fms",
+		       g_timer_elapsed(timer, NULL) * 1000);
+
+	/* as fwupdtool get-tpm-eventlog did before, ignoring PCRs with no measurements */
+	g_timer_reset(timer);
+	for (guint8 i = 0; i < pcrs_all->len; i++) {
+		g_autoptr(GPtrArray) pcrs = fu_tpm_eventlog_calc_checksums(log, i, NULL);
+		g_assert_true(pcrs != NULL || i >= 8);
+	}
+	g_test_message("per-PCR replay of 10000 events: %.1fms",
+		       g_timer_elapsed(timer, NULL) * 1000);
+}
+
 int
 main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
 	g_test_add_func("/fwupd/tpm-eventlog", fu_tpm_eventlog_func);
+	g_test_add_func("/fwupd/tpm-eventlog/all", fu_tpm_eventlog_all_func);
+	if (g_test_perf())
+		g_test_add_func("/fwupd/tpm-eventlog/replay", fu_tpm_eventlog_replay_perf_func);
 	return g_test_run();
 }
@@ -19,3 +19,6 @@ GPtrArray *
 fu_tpm_eventlog_calc_checksums(FuTpmEventlog *self,
 			       guint8 pcr,
 			       GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_NON_NULL(1);
+GPtrArray *
+fu_tpm_eventlog_calc_checksums_all(FuTpmEventlog *self, GError **error) G_GNUC_WARN_UNUSED_RESULT
+    G_GNUC_NON_NULL(1);
@@ -8,6 +8,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "fu-mem-private.h"
 #include "fu-xor.h"
 
@@ -25,11 +27,23 @@
 guint8
 fu_xor8(const guint8 *buf, gsize bufsz)
 {
-	guint8 tmp = 0;
+	guint64 acc = 0;
+	gsize i = 0;
+
 	g_return_val_if_fail(buf != NULL, G_MAXUINT8);
-	for (gsize i = 0; i < bufsz; i++)
-		tmp ^= buf[i];
-	return tmp;
+
+	/* eight bytes at a time, then fold the accumulator down to one byte */
+	for (; bufsz - i >= sizeof(acc); i += sizeof(acc)) {
+		guint64 val;
+		memcpy(&val, buf + i, sizeof(val)); /* nocheck:blocked */
+		acc ^= val;
+	}
+	acc ^= acc >> 32;
+	acc ^= acc >> 16;
+	acc ^= acc >> 8;
+	for (; i < bufsz; i++)
+		acc ^= buf[i];
+	return (guint8)acc;
 }
 
 /**
@@ -19,6 +19,7 @@
 #include <libfwupdplugin/fu-bytes.h>
 #include <libfwupdplugin/fu-cab-firmware.h>
 #include <libfwupdplugin/fu-cab-image.h>
+#include <libfwupdplugin/fu-cached-input-stream.h>
 #include <libfwupdplugin/fu-cfi-device.h>
 #include <libfwupdplugin/fu-cfu-offer.h>
 #include <libfwupdplugin/fu-cfu-payload.h>
@@ -41,6 +42,7 @@
 #include <libfwupdplugin/fu-device.h>
 #include <libfwupdplugin/fu-dfu-firmware.h>
 #include <libfwupdplugin/fu-dfuse-firmware.h>
+#include <libfwupdplugin/fu-digest.h>
 #include <libfwupdplugin/fu-dpaux-device.h>
 #include <libfwupdplugin/fu-drm-device.h>
 #include <libfwupdplugin/fu-dump.h>
@@ -97,6 +99,7 @@
 #include <libfwupdplugin/fu-kernel-search-path.h>
 #include <libfwupdplugin/fu-kernel.h>
 #include <libfwupdplugin/fu-linear-firmware.h>
+#include <libfwupdplugin/fu-mapped-input-stream.h>
 #include <libfwupdplugin/fu-mei-device.h>
 #include <libfwupdplugin/fu-mem.h>
 #include <libfwupdplugin/fu-msgpack-item.h>
@@ -262,6 +262,8 @@ class StructObj:
             "ParseBytes": Export.NONE,
             "ParseStream": Export.NONE,
             "ParseInternal": Export.NONE,
+            "View": Export.NONE,
+            "ViewStream": Export.NONE,
             "New": Export.NONE,
             "NewInternal": Export.NONE,
             "ToString": Export.NONE,
@@ -339,6 +341,8 @@ class StructObj:
             self.add_private_export("ParseInternal")
         elif derive == "ParseBytes":
             self.add_private_export("Parse")
+        elif derive in ["View", "ViewStream"]:
+            self.add_private_export("ParseInternal")
         elif derive == "ParseInternal":
             self.add_private_export("ToString")
             self.add_private_export("ValidateInternal")
@@ -366,7 +370,7 @@ class StructObj:
             self._exports[derive] = Export.PUBLIC
 
         # for convenience
-        if derive in ["Parse", "ParseBytes", "ParseStream"]:
+        if derive in ["Parse", "ParseBytes", "ParseStream", "View", "ViewStream"]:
             self.add_public_export("Getters")
             for item in self.items:
                 if item.struct_obj:
@@ -115,6 +115,7 @@ fu_cabinet_verify_payload_target(FuCabinet *self,
 {
 	g_autofree gchar *checksum_sha256 = NULL;
 	g_autofree gchar *checksum_sha512 = NULL;
+	g_autoptr(FuDigest) digest = fu_digest_new(FU_DIGEST_KIND_SHA256 | FU_DIGEST_KIND_SHA512);
 	g_autoptr(GPtrArray) results = NULL;
 	g_autoptr(GInputStream) stream = NULL;
 	g_autoptr(JcatBlob) blob_target_sha256 = NULL;
@@ -127,20 +128,20 @@ fu_cabinet_verify_payload_target(FuCabinet *self,
 	if (item == NULL)
 		return FALSE;
 
-	/* add SHA-256 */
+	/* read the payload once for both hashes */
 	stream = fu_firmware_get_stream(img_blob, error);
 	if (stream == NULL)
 		return FALSE;
-	checksum_sha256 = fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, error);
-	if (checksum_sha256 == NULL)
+	if (!fu_digest_update_stream(digest, stream, error))
 		return FALSE;
+
+	/* add SHA-256 */
+	checksum_sha256 = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA256);
 	blob_target_sha256 = jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA256, checksum_sha256);
 	jcat_item_add_blob(item_target, blob_target_sha256);
 
 	/* add SHA-512 */
-	checksum_sha512 = fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA512, error);
-	if (checksum_sha512 == NULL)
-		return FALSE;
+	checksum_sha512 = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA512);
 	blob_target_sha512 = jcat_blob_new_utf8(JCAT_BLOB_KIND_SHA512, checksum_sha512);
 	jcat_item_add_blob(item_target, blob_target_sha512);
 
@@ -996,6 +997,7 @@ fu_cabinet_parse(FuFirmware *firmware,
 		 GError **error)
 {
 	FuCabinet *self = FU_CABINET(firmware);
+	g_autoptr(FuDigest) digest = NULL;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(XbQuery) query = NULL;
@@ -1022,14 +1024,11 @@ fu_cabinet_parse(FuFirmware *firmware,
 				 flags | FU_FIRMWARE_PARSE_FLAG_ONLY_BASENAME,
 				 error))
 			return FALSE;
-		self->container_checksum =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA1, error);
-		if (self->container_checksum == NULL)
-			return FALSE;
-		self->container_checksum_alt =
-		    fu_input_stream_compute_checksum(stream, G_CHECKSUM_SHA256, error);
-		if (self->container_checksum_alt == NULL)
+		digest = fu_digest_new(FU_DIGEST_KIND_SHA1 | FU_DIGEST_KIND_SHA256);
+		if (!fu_digest_update_stream(digest, stream, error))
 			return FALSE;
+		self->container_checksum = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA1);
+		self->container_checksum_alt = fu_digest_get_string(digest, FU_DIGEST_KIND_SHA256);
 	}
 
 	/* build xmlb silo */
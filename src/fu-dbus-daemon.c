@@ -26,6 +26,7 @@
 #include "fu-engine-requirements.h"
 #include "fu-polkit-authority.h"
 #include "fu-release.h"
+#include "fu-response-cache.h"
 #include "fu-security-attrs-private.h"
 
 #ifdef HAVE_GIO_UNIX
@@ -44,16 +45,21 @@ struct _FuDbusDaemon {
 	guint percentage;   /* last emitted */
 	guint owner_id;
 	GPtrArray *system_inhibits;
+	FuResponseCache *response_cache;
 };
 
 G_DEFINE_TYPE(FuDbusDaemon, fu_dbus_daemon, FU_TYPE_DAEMON)
 
 #define FU_DBUS_DAEMON_SYSTEM_INHIBIT_MAX_TOTAL	     100
 #define FU_DBUS_DAEMON_SYSTEM_INHIBIT_MAX_PER_SENDER 10
+#define FU_DBUS_DAEMON_PROGRESS_RATE_LIMIT	     10 /* per second */
 
 static void
 fu_dbus_daemon_engine_changed_cb(FuEngine *engine, FuDbusDaemon *self)
 {
+	/* metadata, remotes or config changed */
+	fu_response_cache_invalidate(self->response_cache);
+
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
@@ -67,11 +73,33 @@ fu_dbus_daemon_engine_changed_cb(FuEngine *engine, FuDbusDaemon *self)
 	fu_daemon_schedule_housekeeping(FU_DAEMON(self));
 }
 
+static void
+fu_dbus_daemon_engine_config_changed_cb(FuEngineConfig *config, FuDbusDaemon *self)
+{
+	/* e.g. ShowDevicePrivate or the blocked firmware */
+	fu_response_cache_invalidate(self->response_cache);
+}
+
+static void
+fu_dbus_daemon_device_notify_cb(FuDevice *device, GParamSpec *pspec, FuDbusDaemon *self)
+{
+	/* e.g. the version or flags changed, which affects the devices and the upgrades --
+	 * changes that are not notified are not sent as DeviceChanged to clients either */
+	fu_response_cache_invalidate(self->response_cache);
+}
+
 static void
 fu_dbus_daemon_engine_device_added_cb(FuEngine *engine, FuDevice *device, FuDbusDaemon *self)
 {
 	GVariant *val;
 
+	fu_response_cache_invalidate(self->response_cache);
+	g_signal_connect_object(FU_DEVICE(device),
+				"notify",
+				G_CALLBACK(fu_dbus_daemon_device_notify_cb),
+				self,
+				0);
+
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
@@ -91,6 +119,9 @@ fu_dbus_daemon_engine_device_removed_cb(FuEngine *engine, FuDevice *device, FuDb
 {
 	GVariant *val;
 
+	fu_response_cache_invalidate(self->response_cache);
+	g_signal_handlers_disconnect_by_func(device, fu_dbus_daemon_device_notify_cb, self);
+
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
@@ -110,6 +141,8 @@ fu_dbus_daemon_engine_device_changed_cb(FuEngine *engine, FuDevice *device, FuDb
 {
 	GVariant *val;
 
+	fu_response_cache_invalidate(self->response_cache);
+
 	/* not yet connected */
 	if (self->connection == NULL)
 		return;
@@ -339,6 +372,39 @@ fu_dbus_daemon_method_invocation_return_gerror(GDBusMethodInvocation *invocation
 	g_dbus_method_invocation_return_gerror(invocation, error);
 }
 
+/* the response also depends on what the client supports, and if it is trusted */
+static gchar *
+fu_dbus_daemon_response_cache_key(FuEngineRequest *request,
+				  const gchar *method_name,
+				  const gchar *device_id)
+{
+	const gchar *locale = fu_engine_request_get_locale(request);
+	return g_strdup_printf("%s(%s):%s:0x%" G_GINT64_MODIFIER "x:0x%x",
+			       method_name,
+			       device_id != NULL ? device_id : "",
+			       locale != NULL ? locale : "",
+			       (guint64)fu_engine_request_get_feature_flags(request),
+			       (guint)fu_engine_request_get_converter_flags(request));
+}
+
+static gboolean
+fu_dbus_daemon_method_invocation_return_cached(FuDbusDaemon *self,
+					       GDBusMethodInvocation *invocation,
+					       const gchar *key)
+{
+	g_autoptr(GVariant) val = NULL;
+
+	val = fu_response_cache_lookup(self->response_cache, key);
+	if (val == NULL)
+		return FALSE;
+	g_debug("using cached response for %s (hits: %u, misses: %u)",
+		key,
+		fu_response_cache_get_hits(self->response_cache),
+		fu_response_cache_get_misses(self->response_cache));
+	g_dbus_method_invocation_return_value(invocation, val);
+	return TRUE;
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-function"
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuMainAuthHelper, fu_dbus_daemon_auth_helper_free)
@@ -435,6 +501,7 @@ fu_dbus_daemon_authorize_set_approved_firmware_cb(GObject *source,
 		const gchar *csum = g_ptr_array_index(helper->checksums, i);
 		fu_engine_add_approved_firmware(engine, csum);
 	}
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -458,6 +525,7 @@ fu_dbus_daemon_authorize_fix_host_security_attr_cb(GObject *source,
 		fu_dbus_daemon_method_invocation_return_gerror(helper->invocation, error);
 		return;
 	}
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -481,6 +549,7 @@ fu_dbus_daemon_authorize_undo_host_security_attr_cb(GObject *source,
 		fu_dbus_daemon_method_invocation_return_gerror(helper->invocation, error);
 		return;
 	}
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -528,6 +597,7 @@ fu_dbus_daemon_modify_config_cb(GObject *source, GAsyncResult *res, gpointer use
 	}
 
 	/* success */
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -549,6 +619,7 @@ fu_dbus_daemon_reset_config_cb(GObject *source, GAsyncResult *res, gpointer user
 	}
 
 	/* success */
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -590,6 +661,7 @@ fu_dbus_daemon_authorize_activate_cb(GObject *source, GAsyncResult *res, gpointe
 
 	/* progress */
 	fu_progress_set_profile(progress, g_log_get_debug_enabled());
+	fu_progress_set_rate_limit(progress, FU_DBUS_DAEMON_PROGRESS_RATE_LIMIT);
 	g_signal_connect(FU_PROGRESS(progress),
 			 "percentage-changed",
 			 G_CALLBACK(fu_dbus_daemon_progress_percentage_changed_cb),
@@ -625,6 +697,7 @@ fu_dbus_daemon_authorize_verify_update_cb(GObject *source, GAsyncResult *res, gp
 
 	/* progress */
 	fu_progress_set_profile(progress, g_log_get_debug_enabled());
+	fu_progress_set_rate_limit(progress, FU_DBUS_DAEMON_PROGRESS_RATE_LIMIT);
 	g_signal_connect(FU_PROGRESS(progress),
 			 "percentage-changed",
 			 G_CALLBACK(fu_dbus_daemon_progress_percentage_changed_cb),
@@ -668,6 +741,7 @@ fu_dbus_daemon_authorize_modify_remote_cb(GObject *source, GAsyncResult *res, gp
 	}
 
 	/* success */
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -691,6 +765,7 @@ fu_dbus_daemon_authorize_clean_remote_cb(GObject *source, GAsyncResult *res, gpo
 	}
 
 	/* success */
+	fu_response_cache_invalidate(helper->self->response_cache);
 	g_dbus_method_invocation_return_value(helper->invocation, NULL);
 }
 
@@ -1198,9 +1273,15 @@ fu_dbus_daemon_method_get_devices(FuDbusDaemon *self,
 {
 	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
 	GVariant *val;
+	g_autofree gchar *key = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
 
+	/* nothing has changed since an identical request */
+	key = fu_dbus_daemon_response_cache_key(request, "GetDevices", NULL);
+	if (fu_dbus_daemon_method_invocation_return_cached(self, invocation, key))
+		return;
+
 	devices = fu_engine_get_devices(engine, &error);
 	if (devices == NULL) {
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
@@ -1211,6 +1292,7 @@ fu_dbus_daemon_method_get_devices(FuDbusDaemon *self,
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
+	fu_response_cache_add_value(self->response_cache, key, val);
 	g_dbus_method_invocation_return_value(invocation, val);
 }
 
@@ -1449,18 +1531,70 @@ fu_dbus_daemon_method_get_upgrades(FuDbusDaemon *self,
 {
 	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
 	const gchar *device_id;
+	GVariant *val;
+	g_autofree gchar *key = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
 
 	g_variant_get(parameters, "(&s)", &device_id);
+
+	/* nothing has changed since an identical request */
+	key = fu_dbus_daemon_response_cache_key(request, "GetUpgrades", device_id);
+	if (fu_dbus_daemon_method_invocation_return_cached(self, invocation, key))
+		return;
+
 	releases = fu_engine_get_upgrades(engine, request, device_id, &error);
 	if (releases == NULL) {
 		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
 		return;
 	}
-	g_dbus_method_invocation_return_value(
-	    invocation,
-	    fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE));
+	val = fwupd_codec_array_to_variant(releases, FWUPD_CODEC_FLAG_NONE);
+	fu_response_cache_add_value(self->response_cache, key, val);
+	g_dbus_method_invocation_return_value(invocation, val);
+}
+
+static void
+fu_dbus_daemon_method_get_upgrades_all(FuDbusDaemon *self,
+				       GVariant *parameters,
+				       FuEngineRequest *request,
+				       GDBusMethodInvocation *invocation)
+{
+	FuEngine *engine = fu_daemon_get_engine(FU_DAEMON(self));
+	GHashTableIter iter;
+	GPtrArray *releases;
+	GVariant *val;
+	GVariantBuilder builder;
+	const gchar *device_id;
+	g_autofree gchar *key = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) upgrades = NULL;
+
+	/* nothing has changed since an identical request */
+	key = fu_dbus_daemon_response_cache_key(request, "GetUpgradesAll", NULL);
+	if (fu_dbus_daemon_method_invocation_return_cached(self, invocation, key))
+		return;
+
+	upgrades = fu_engine_get_upgrades_all(engine, request, &error);
+	if (upgrades == NULL) {
+		fu_dbus_daemon_method_invocation_return_gerror(invocation, error);
+		return;
+	}
+	g_variant_builder_init(&builder, G_VARIANT_TYPE("a{saa{sv}}"));
+	g_hash_table_iter_init(&iter, upgrades);
+	while (g_hash_table_iter_next(&iter, (gpointer *)&device_id, (gpointer *)&releases)) {
+		GVariantBuilder builder_rels;
+		g_variant_builder_init(&builder_rels, G_VARIANT_TYPE("aa{sv}"));
+		for (guint i = 0; i < releases->len; i++) {
+			FwupdCodec *codec = FWUPD_CODEC(g_ptr_array_index(releases, i));
+			g_variant_builder_add_value(&builder_rels,
+						    fwupd_codec_to_variant(codec,
+									   FWUPD_CODEC_FLAG_NONE));
+		}
+		g_variant_builder_add(&builder, "{saa{sv}}", device_id, &builder_rels);
+	}
+	val = g_variant_new("(a{saa{sv}})", &builder);
+	fu_response_cache_add_value(self->response_cache, key, val);
+	g_dbus_method_invocation_return_value(invocation, val);
 }
 
 static void
@@ -2099,6 +2233,7 @@ fu_dbus_daemon_method_verify(FuDbusDaemon *self,
 
 	/* progress */
 	fu_progress_set_profile(progress, g_log_get_debug_enabled());
+	fu_progress_set_rate_limit(progress, FU_DBUS_DAEMON_PROGRESS_RATE_LIMIT);
 	g_signal_connect(FU_PROGRESS(progress),
 			 "percentage-changed",
 			 G_CALLBACK(fu_dbus_daemon_progress_percentage_changed_cb),
@@ -2231,6 +2366,7 @@ fu_dbus_daemon_method_install(FuDbusDaemon *self,
 	helper = g_new0(FuMainAuthHelper, 1);
 	helper->request = g_object_ref(request);
 	helper->progress = fu_progress_new(G_STRLOC);
+	fu_progress_set_rate_limit(helper->progress, FU_DBUS_DAEMON_PROGRESS_RATE_LIMIT);
 	helper->invocation = g_object_ref(invocation);
 	helper->device_id = g_strdup(device_id);
 	helper->self = self;
@@ -2529,6 +2665,7 @@ fu_dbus_daemon_method_call(GDBusConnection *connection,
 	    {"SelfSign", fu_dbus_daemon_method_self_sign},
 	    {"GetDowngrades", fu_dbus_daemon_method_get_downgrades},
 	    {"GetUpgrades", fu_dbus_daemon_method_get_upgrades},
+	    {"GetUpgradesAll", fu_dbus_daemon_method_get_upgrades_all},
 	    {"GetRemotes", fu_dbus_daemon_method_get_remotes},
 	    {"GetHistory", fu_dbus_daemon_method_get_history},
 	    {"GetHostSecurityAttrs", fu_dbus_daemon_method_get_host_security_attrs},
@@ -2707,6 +2844,10 @@ fu_dbus_daemon_get_property(GDBusConnection *connection_,
 	}
 	if (g_strcmp0(property_name, "Hwids") == 0)
 		return fu_dbus_daemon_get_property_hwids(self);
+	if (g_strcmp0(property_name, "ResponseCacheHits") == 0)
+		return g_variant_new_uint32(fu_response_cache_get_hits(self->response_cache));
+	if (g_strcmp0(property_name, "ResponseCacheMisses") == 0)
+		return g_variant_new_uint32(fu_response_cache_get_misses(self->response_cache));
 
 	/* return an error */
 	g_set_error(error, /* nocheck:error */
@@ -2922,6 +3063,10 @@ fu_dbus_daemon_setup(FuDaemon *daemon,
 			 "status-changed",
 			 G_CALLBACK(fu_dbus_daemon_engine_status_changed_cb),
 			 self);
+	g_signal_connect(FU_ENGINE_CONFIG(fu_engine_get_config(engine)),
+			 "changed",
+			 G_CALLBACK(fu_dbus_daemon_engine_config_changed_cb),
+			 self);
 	if (!fu_engine_load(engine,
 			    FU_ENGINE_LOAD_FLAG_COLDPLUG | FU_ENGINE_LOAD_FLAG_HWINFO |
 				FU_ENGINE_LOAD_FLAG_REMOTES | FU_ENGINE_LOAD_FLAG_EXTERNAL_PLUGINS |
@@ -2998,6 +3143,7 @@ fu_dbus_daemon_init(FuDbusDaemon *self)
 	self->status = FWUPD_STATUS_IDLE;
 	self->system_inhibits =
 	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_dbus_daemon_system_inhibit_free);
+	self->response_cache = fu_response_cache_new();
 }
 
 static void
@@ -3006,6 +3152,7 @@ fu_dbus_daemon_finalize(GObject *obj)
 	FuDbusDaemon *self = FU_DBUS_DAEMON(obj);
 
 	g_ptr_array_unref(self->system_inhibits);
+	g_object_unref(self->response_cache);
 	if (self->client_list != NULL)
 		g_object_unref(self->client_list);
 	if (self->owner_id > 0)
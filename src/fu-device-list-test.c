@@ -559,6 +559,40 @@ fu_device_list_equivalent_id_func(void)
 	g_assert_null(device4);
 }
 
+static void
+fu_device_list_index_func(void)
+{
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device = fu_device_new(ctx);
+	g_autoptr(FuDevice) device1 = NULL;
+	g_autoptr(FuDevice) device2 = NULL;
+	g_autoptr(FuDevice) device3 = NULL;
+	g_autoptr(FuDeviceList) device_list = fu_device_list_new();
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *guid = fwupd_guid_hash_string("baz");
+
+	fu_device_set_id(device, "8e9cb71aeca70d2faedb5b8aaa263f6175086b2e");
+	fu_device_add_instance_id(device, "foobar");
+	fu_device_list_add(device_list, device);
+
+	/* the ID changed after the device was added */
+	fu_device_set_id(device, "1a8d0d9a96ad3e67ba76cf3033623625dc6d6882");
+	device1 = fu_device_list_get_by_id(device_list, "1a8d", &error);
+	g_assert_no_error(error);
+	g_assert_true(device1 == device);
+	device2 = fu_device_list_get_by_id(device_list, "8e9c", &error);
+	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null(device2);
+	g_clear_error(&error);
+
+	/* a GUID was added after the device was added */
+	fu_device_add_instance_id(device, "baz");
+	fu_device_convert_instance_ids(device);
+	device3 = fu_device_list_get_by_guid(device_list, guid, &error);
+	g_assert_no_error(error);
+	g_assert_true(device3 == device);
+}
+
 static void
 fu_device_list_unconnected_no_delay_func(void)
 {
@@ -659,6 +693,15 @@ fu_device_list_func(void)
 	device = fu_device_list_get_by_guid(device_list, "notfound", &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
 	g_assert_null(device);
+	g_clear_error(&error);
+
+	/* find by GUID added after the device */
+	fu_device_add_instance_id(device2, "notfound");
+	device = fu_device_list_get_by_guid(device_list, "notfound", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(device);
+	g_assert_cmpstr(fu_device_get_id(device), ==, fu_device_get_id(device2));
+	g_clear_object(&device);
 
 	/* remove device */
 	added_cnt = removed_cnt = changed_cnt = 0;
@@ -680,6 +723,7 @@ main(int argc, char **argv)
 	g_test_add_func("/fwupd/device-list/unconnected-no-delay",
 			fu_device_list_unconnected_no_delay_func);
 	g_test_add_func("/fwupd/device-list/equivalent-id", fu_device_list_equivalent_id_func);
+	g_test_add_func("/fwupd/device-list/index", fu_device_list_index_func);
 	g_test_add_func("/fwupd/device-list/delay", fu_device_list_delay_func);
 	g_test_add_func("/fwupd/device-list/explicit-order", fu_device_list_explicit_order_func);
 	g_test_add_func("/fwupd/device-list/explicit-order-post",
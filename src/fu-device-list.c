@@ -33,6 +33,10 @@ struct _FuDeviceList {
 	GObject parent_instance;
 	GPtrArray *devices; /* of FuDeviceItem */
 	GRWLock devices_mutex;
+	GHashTable *guid_index;	       /* (element-type utf8 GPtrArray) of FuDeviceItem */
+	GHashTable *physical_id_index; /* (element-type utf8 GPtrArray) of FuDeviceItem */
+	GHashTable *id_prefix_index;   /* (element-type utf8 GPtrArray) of FuDeviceItem */
+	guint64 order_next;
 };
 
 enum { SIGNAL_ADDED, SIGNAL_REMOVED, SIGNAL_CHANGED, SIGNAL_LAST };
@@ -51,8 +55,20 @@ typedef struct {
 	FuDevice *device_old;
 	FuDeviceList *self; /* no ref */
 	guint remove_id;
+	guint64 order;	       /* position in self->devices */
+	GPtrArray *index_keys; /* of FuDeviceListIndexKey */
+	gulong device_notify_ids[4];
+	gulong device_old_notify_ids[4];
 } FuDeviceItem;
 
+typedef struct {
+	GHashTable *index; /* no ref */
+	gchar *key;
+} FuDeviceListIndexKey;
+
+/* device IDs are SHA-1 hashes, and can be abbreviated to this length */
+#define FU_DEVICE_LIST_ID_PREFIX_LEN 4
+
 static void
 fu_device_list_codec_iface_init(FwupdCodecInterface *iface);
 
@@ -244,6 +260,159 @@ fu_device_list_get_active(FuDeviceList *self)
 	return devices;
 }
 
+static void
+fu_device_list_index_key_free(FuDeviceListIndexKey *index_key)
+{
+	g_free(index_key->key);
+	g_free(index_key);
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_index_add(GHashTable *index, const gchar *key, FuDeviceItem *item)
+{
+	GPtrArray *items;
+	FuDeviceListIndexKey *index_key;
+
+	if (key == NULL)
+		return;
+	items = g_hash_table_lookup(index, key);
+	if (items == NULL) {
+		items = g_ptr_array_new();
+		g_hash_table_insert(index, g_strdup(key), items);
+	} else if (g_ptr_array_find(items, item, NULL)) {
+		return;
+	}
+	g_ptr_array_add(items, item);
+
+	/* so it can be removed without knowing what the device used to be */
+	index_key = g_new0(FuDeviceListIndexKey, 1);
+	index_key->index = index;
+	index_key->key = g_strdup(key);
+	g_ptr_array_add(item->index_keys, index_key);
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_index_remove_item(FuDeviceItem *item)
+{
+	for (guint i = 0; i < item->index_keys->len; i++) {
+		FuDeviceListIndexKey *index_key = g_ptr_array_index(item->index_keys, i);
+		GPtrArray *items = g_hash_table_lookup(index_key->index, index_key->key);
+		if (items == NULL)
+			continue;
+		g_ptr_array_remove(items, item);
+		if (items->len == 0)
+			g_hash_table_remove(index_key->index, index_key->key);
+	}
+	g_ptr_array_set_size(item->index_keys, 0);
+}
+
+static void
+fu_device_list_index_add_id_prefix(FuDeviceList *self, const gchar *id, FuDeviceItem *item)
+{
+	gchar prefix[FU_DEVICE_LIST_ID_PREFIX_LEN + 1] = {'\0'};
+	if (id == NULL || strlen(id) < FU_DEVICE_LIST_ID_PREFIX_LEN)
+		return;
+	g_strlcpy(prefix, id, sizeof(prefix));
+	fu_device_list_index_add(self->id_prefix_index, prefix, item);
+}
+
+static void
+fu_device_list_index_add_device(FuDeviceList *self, FuDevice *device, FuDeviceItem *item)
+{
+	GPtrArray *guids = fu_device_get_guids(device);
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index(guids, i);
+		fu_device_list_index_add(self->guid_index, guid, item);
+	}
+	fu_device_list_index_add(self->physical_id_index, fu_device_get_physical_id(device), item);
+	fu_device_list_index_add_id_prefix(self, fu_device_get_id(device), item);
+	fu_device_list_index_add_id_prefix(self, fu_device_get_equivalent_id(device), item);
+}
+
+/* must be called with the writer lock held */
+static void
+fu_device_list_item_reindex(FuDeviceItem *item)
+{
+	FuDeviceList *self = FU_DEVICE_LIST(item->self);
+	fu_device_list_index_remove_item(item);
+	if (item->device != NULL)
+		fu_device_list_index_add_device(self, item->device, item);
+	if (item->device_old != NULL)
+		fu_device_list_index_add_device(self, item->device_old, item);
+}
+
+/* the indexes have to be updated when any of the keys change */
+static void
+fu_device_list_item_notify_cb(FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceItem *item = (FuDeviceItem *)user_data;
+	FuDeviceList *self = FU_DEVICE_LIST(item->self);
+
+	g_rw_lock_writer_lock(&self->devices_mutex);
+	fu_device_list_item_reindex(item);
+	g_rw_lock_writer_unlock(&self->devices_mutex);
+}
+
+/* GUIDs are only ever added, so there is no need to rebuild the other indexes */
+static void
+fu_device_list_item_guids_notify_cb(FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceItem *item = (FuDeviceItem *)user_data;
+	FuDeviceList *self = FU_DEVICE_LIST(item->self);
+	GPtrArray *guids = fu_device_get_guids(device);
+
+	g_rw_lock_writer_lock(&self->devices_mutex);
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index(guids, i);
+		fu_device_list_index_add(self->guid_index, guid, item);
+	}
+	g_rw_lock_writer_unlock(&self->devices_mutex);
+}
+
+/* nocheck:name */
+static void
+fu_device_list_item_watch(FuDeviceItem *item,
+			  FuDevice *device_watched,
+			  gulong *notify_ids,
+			  FuDevice *device)
+{
+	const gchar *signals[] = {"notify::id",
+				  "notify::equivalent-id",
+				  "notify::physical-id",
+				  "notify::guids"};
+	GCallback callbacks[] = {G_CALLBACK(fu_device_list_item_notify_cb),
+				 G_CALLBACK(fu_device_list_item_notify_cb),
+				 G_CALLBACK(fu_device_list_item_notify_cb),
+				 G_CALLBACK(fu_device_list_item_guids_notify_cb)};
+
+	G_STATIC_ASSERT(G_N_ELEMENTS(signals) == G_N_ELEMENTS(item->device_notify_ids));
+	G_STATIC_ASSERT(G_N_ELEMENTS(callbacks) == G_N_ELEMENTS(signals));
+	for (guint i = 0; i < G_N_ELEMENTS(signals); i++) {
+		if (notify_ids[i] != 0) {
+			if (g_signal_handler_is_connected(device_watched, notify_ids[i]))
+				g_signal_handler_disconnect(device_watched, notify_ids[i]);
+			notify_ids[i] = 0;
+		}
+		if (device != NULL)
+			notify_ids[i] = g_signal_connect(device, signals[i], callbacks[i], item);
+	}
+}
+
+/* returns the first item in list order */
+static FuDeviceItem *
+fu_device_list_items_get_first(GPtrArray *items)
+{
+	FuDeviceItem *item_first = NULL;
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item = g_ptr_array_index(items, i);
+		if (item_first == NULL || item->order < item_first->order)
+			item_first = item;
+	}
+	return item_first;
+}
+
 static FuDeviceItem *
 fu_device_list_find_by_device(FuDeviceList *self, FuDevice *device)
 {
@@ -263,23 +432,53 @@ fu_device_list_find_by_device(FuDeviceList *self, FuDevice *device)
 }
 
 static FuDeviceItem *
-fu_device_list_find_by_guid(FuDeviceList *self, const gchar *guid)
+fu_device_list_find_by_guid_indexed(FuDeviceList *self, const gchar *guid)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
-	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
+	GPtrArray *items;
+	g_autoptr(GPtrArray) items_match = g_ptr_array_new();
+
+	items = g_hash_table_lookup(self->guid_index, guid);
+	if (items == NULL)
+		return NULL;
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item = g_ptr_array_index(items, i);
 		if (fu_device_has_guid(item->device, guid))
-			return item;
+			g_ptr_array_add(items_match, item);
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index(self->devices, i);
+	if (items_match->len > 0)
+		return fu_device_list_items_get_first(items_match);
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item = g_ptr_array_index(items, i);
 		if (item->device_old == NULL)
 			continue;
 		if (fu_device_has_guid(item->device_old, guid))
-			return item;
+			g_ptr_array_add(items_match, item);
 	}
-	return NULL;
+	return fu_device_list_items_get_first(items_match);
+}
+
+/* the index is kept current as GUIDs are added, so a miss means no device has the GUID */
+static FuDeviceItem *
+fu_device_list_find_by_guid(FuDeviceList *self, const gchar *guid)
+{
+	g_autofree gchar *guid_valid = NULL;
+	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
+	g_return_val_if_fail(locker != NULL, NULL);
+
+	/* an instance ID, in the same way as fu_device_has_guid() */
+	if (!fwupd_guid_is_valid(guid))
+		guid_valid = fwupd_guid_hash_string(guid);
+	return fu_device_list_find_by_guid_indexed(self, guid_valid != NULL ? guid_valid : guid);
+}
+
+/* nocheck:name */
+static gboolean
+fu_device_list_device_has_connection(FuDevice *device,
+				     const gchar *physical_id,
+				     const gchar *logical_id)
+{
+	return device != NULL && g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
+	       g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0;
 }
 
 static FuDeviceItem *
@@ -287,28 +486,32 @@ fu_device_list_find_by_connection(FuDeviceList *self,
 				  const gchar *physical_id,
 				  const gchar *logical_id)
 {
+	GPtrArray *items;
+	g_autoptr(GPtrArray) items_match = g_ptr_array_new();
 	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
 	if (physical_id == NULL)
 		return NULL;
 	locker = g_rw_lock_reader_locker_new(&self->devices_mutex);
 	g_return_val_if_fail(locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
-		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
+	items = g_hash_table_lookup(self->physical_id_index, physical_id);
+	if (items == NULL)
+		return NULL;
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item_tmp = g_ptr_array_index(items, i);
+		if (fu_device_list_device_has_connection(item_tmp->device, physical_id, logical_id))
+			g_ptr_array_add(items_match, item_tmp);
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
-		FuDevice *device = item_tmp->device_old;
-		if (device != NULL &&
-		    g_strcmp0(fu_device_get_physical_id(device), physical_id) == 0 &&
-		    g_strcmp0(fu_device_get_logical_id(device), logical_id) == 0)
-			return item_tmp;
+	if (items_match->len > 0)
+		return fu_device_list_items_get_first(items_match);
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item_tmp = g_ptr_array_index(items, i);
+		if (fu_device_list_device_has_connection(item_tmp->device_old,
+							 physical_id,
+							 logical_id))
+			g_ptr_array_add(items_match, item_tmp);
 	}
-	return NULL;
+	return fu_device_list_items_get_first(items_match);
 }
 
 static gint
@@ -320,6 +523,10 @@ fu_device_list_item_sort_by_priority_cb(gconstpointer a, gconstpointer b)
 		return 1;
 	if (fu_device_get_priority(item1->device) > fu_device_get_priority(item2->device))
 		return -1;
+	if (item1->order > item2->order)
+		return 1;
+	if (item1->order < item2->order)
+		return -1;
 	return 0;
 }
 
@@ -327,13 +534,15 @@ static GPtrArray *
 fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError **error)
 {
 	gsize device_id_len;
+	gchar prefix[FU_DEVICE_LIST_ID_PREFIX_LEN + 1] = {'\0'};
+	GPtrArray *items_prefix;
 	g_autoptr(GPtrArray) items = g_ptr_array_new();
 
 	g_return_val_if_fail(device_id != NULL, NULL);
 
 	/* support abbreviated hashes */
 	device_id_len = strlen(device_id);
-	if (device_id_len < 4) {
+	if (device_id_len < FU_DEVICE_LIST_ID_PREFIX_LEN) {
 		g_set_error(error,
 			    FWUPD_ERROR,
 			    FWUPD_ERROR_INTERNAL,
@@ -341,9 +550,11 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 			    device_id);
 		return NULL;
 	}
+	g_strlcpy(prefix, device_id, sizeof(prefix));
 	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
+	items_prefix = g_hash_table_lookup(self->id_prefix_index, prefix);
+	for (guint i = 0; items_prefix != NULL && i < items_prefix->len; i++) {
+		FuDeviceItem *item_tmp = g_ptr_array_index(items_prefix, i);
 		const gchar *ids[] = {fu_device_get_id(item_tmp->device),
 				      fu_device_get_equivalent_id(item_tmp->device),
 				      NULL};
@@ -362,8 +573,9 @@ fu_device_list_filter_by_id(FuDeviceList *self, const gchar *device_id, GError *
 
 	/* only search old devices if we didn't find the active device */
 	g_rw_lock_reader_lock(&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index(self->devices, i);
+	items_prefix = g_hash_table_lookup(self->id_prefix_index, prefix);
+	for (guint i = 0; items_prefix != NULL && i < items_prefix->len; i++) {
+		FuDeviceItem *item_tmp = g_ptr_array_index(items_prefix, i);
 		const gchar *ids[3] = {NULL};
 		if (item_tmp->device_old == NULL)
 			continue;
@@ -676,6 +888,7 @@ fu_device_list_item_set_device_old(FuDeviceItem *item, FuDevice *device)
 {
 	fu_device_set_parent(device, NULL);
 	fu_device_remove_children(device);
+	fu_device_list_item_watch(item, item->device_old, item->device_old_notify_ids, device);
 	g_set_object(&item->device_old, device);
 }
 
@@ -689,6 +902,7 @@ fu_device_list_item_set_device(FuDeviceItem *item, FuDevice *device)
 	if (device != NULL) {
 		g_object_weak_ref(G_OBJECT(device), fu_device_list_item_finalized_cb, item);
 	}
+	fu_device_list_item_watch(item, item->device, item->device_notify_ids, device);
 	g_set_object(&item->device, device);
 }
 
@@ -792,6 +1006,9 @@ fu_device_list_replace(FuDeviceList *self, FuDeviceItem *item, FuDevice *device)
 	/* assign the new device */
 	fu_device_list_item_set_device_old(item, item->device);
 	fu_device_list_item_set_device(item, device);
+	g_rw_lock_writer_lock(&self->devices_mutex);
+	fu_device_list_item_reindex(item);
+	g_rw_lock_writer_unlock(&self->devices_mutex);
 	fu_device_list_emit_device_changed(self, device);
 
 	/* debug */
@@ -856,8 +1073,15 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 					      device,
 					      FU_DEVICE_INCORPORATE_FLAG_UPDATE_ERROR |
 						  FU_DEVICE_INCORPORATE_FLAG_UPDATE_ERROR);
+			fu_device_list_item_watch(item,
+						  item->device_old,
+						  item->device_old_notify_ids,
+						  item->device);
 			g_set_object(&item->device_old, item->device);
 			fu_device_list_item_set_device(item, device);
+			g_rw_lock_writer_lock(&self->devices_mutex);
+			fu_device_list_item_reindex(item);
+			g_rw_lock_writer_unlock(&self->devices_mutex);
 			fu_device_list_clear_wait_for_replug(self, item);
 			fu_device_list_emit_device_changed(self, device);
 			return;
@@ -926,9 +1150,13 @@ fu_device_list_add(FuDeviceList *self, FuDevice *device)
 	/* add helper */
 	item = g_new0(FuDeviceItem, 1);
 	item->self = self; /* no ref */
+	item->index_keys =
+	    g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_index_key_free);
 	fu_device_list_item_set_device(item, device);
 	g_rw_lock_writer_lock(&self->devices_mutex);
+	item->order = self->order_next++;
 	g_ptr_array_add(self->devices, item);
+	fu_device_list_item_reindex(item);
 	g_rw_lock_writer_unlock(&self->devices_mutex);
 	fu_device_list_emit_device_added(self, device);
 }
@@ -1094,11 +1322,15 @@ fu_device_list_get_by_id(FuDeviceList *self, const gchar *device_id, GError **er
 	return g_object_ref(item->device);
 }
 
+/* always called with the writer lock held, or from dispose */
 static void
 fu_device_list_item_free(FuDeviceItem *item)
 {
 	if (item->remove_id != 0)
 		g_source_remove(item->remove_id);
+	fu_device_list_index_remove_item(item);
+	g_ptr_array_unref(item->index_keys);
+	fu_device_list_item_watch(item, item->device_old, item->device_old_notify_ids, NULL);
 	if (item->device_old != NULL)
 		g_object_unref(item->device_old);
 	fu_device_list_item_set_device(item, NULL);
@@ -1189,6 +1421,18 @@ static void
 fu_device_list_init(FuDeviceList *self)
 {
 	self->devices = g_ptr_array_new_with_free_func((GDestroyNotify)fu_device_list_item_free);
+	self->guid_index = g_hash_table_new_full(g_str_hash,
+						 g_str_equal,
+						 g_free,
+						 (GDestroyNotify)g_ptr_array_unref);
+	self->physical_id_index = g_hash_table_new_full(g_str_hash,
+							g_str_equal,
+							g_free,
+							(GDestroyNotify)g_ptr_array_unref);
+	self->id_prefix_index = g_hash_table_new_full(g_str_hash,
+						      g_str_equal,
+						      g_free,
+						      (GDestroyNotify)g_ptr_array_unref);
 	g_rw_lock_init(&self->devices_mutex);
 }
 
@@ -1199,6 +1443,9 @@ fu_device_list_finalize(GObject *obj)
 
 	g_rw_lock_clear(&self->devices_mutex);
 	g_ptr_array_unref(self->devices);
+	g_hash_table_unref(self->guid_index);
+	g_hash_table_unref(self->physical_id_index);
+	g_hash_table_unref(self->id_prefix_index);
 
 	G_OBJECT_CLASS(fu_device_list_parent_class)->finalize(obj);
 }
@@ -318,6 +318,12 @@ fu_engine_config_get_ignore_requirements(FuEngineConfig *self)
 	return fu_config_get_value_bool(FU_CONFIG(self), "fwupd", "IgnoreRequirements");
 }
 
+gboolean
+fu_engine_config_get_history_write_ahead_log(FuEngineConfig *self)
+{
+	return fu_config_get_value_bool(FU_CONFIG(self), "fwupd", "HistoryWriteAheadLog");
+}
+
 gboolean
 fu_engine_config_get_ignore_efivars_free_space(FuEngineConfig *self)
 {
@@ -415,6 +421,7 @@ fu_engine_config_init(FuEngineConfig *self)
 	fu_engine_config_set_default(self, "DisabledPlugins", "");
 	fu_engine_config_set_default(self, "EnumerateAllDevices", "false");
 	fu_engine_config_set_default(self, "EspLocation", NULL);
+	fu_engine_config_set_default(self, "HistoryWriteAheadLog", "false");
 	fu_engine_config_set_default(self, "HostBkc", NULL);
 	fu_engine_config_set_default(self, "IdleTimeout", "300");		  /* s */
 	fu_engine_config_set_default(self, "IdleInhibitStartupThreshold", "500"); /* ms */
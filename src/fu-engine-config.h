@@ -49,6 +49,8 @@ fu_engine_config_get_test_devices(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_config_get_ignore_requirements(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 gboolean
+fu_engine_config_get_history_write_ahead_log(FuEngineConfig *self) G_GNUC_NON_NULL(1);
+gboolean
 fu_engine_config_get_ignore_efivars_free_space(FuEngineConfig *self) G_GNUC_NON_NULL(1);
 gboolean
 fu_engine_config_get_only_trust_pq_signatures(FuEngineConfig *self) G_GNUC_NON_NULL(1);
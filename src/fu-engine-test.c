@@ -165,6 +165,96 @@ fu_engine_generate_md_func(void)
 	g_assert_cmpstr(tmp, ==, NULL);
 }
 
+static void
+fu_engine_metadata_remotes_func(void)
+{
+	gboolean ret;
+	g_autofree gchar *fn_stable = NULL;
+	g_autofree gchar *fn_testing = NULL;
+	g_autoptr(FuContext) ctx = fu_context_new_full(FU_CONTEXT_FLAG_NO_QUIRKS);
+	g_autoptr(FuDevice) device1 = fu_device_new(ctx);
+	g_autoptr(FuDevice) device2 = fu_device_new(ctx);
+	g_autoptr(FuEngine) engine = fu_engine_new(ctx);
+	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
+	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) component1 = NULL;
+	g_autoptr(XbNode) component2 = NULL;
+	g_autoptr(XbNode) component3 = NULL;
+
+	/* set up test harness */
+	tmpdir = fu_temporary_directory_new("self-tests", &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_LOCALSTATEDIR_METADATA, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_CACHEDIR_PKG, tmpdir);
+	fu_context_set_tmpdir(ctx, FU_PATH_KIND_DATADIR_PKG, tmpdir);
+	fu_engine_save_remote_stable(tmpdir);
+	fu_engine_save_remote_testing(tmpdir);
+
+	/* one component in each remote */
+	fn_stable = fu_temporary_directory_build(tmpdir, "stable.xml", NULL);
+	ret = g_file_set_contents(fn_stable,
+				  "<components>"
+				  "  <component type=\"firmware\">"
+				  "    <id>stable</id>"
+				  "    <provides>"
+				  "      <firmware type=\"flashed\">"
+				  "aaaaaaaa-bbbb-cccc-dddd-eeeeeeeeeeee</firmware>"
+				  "    </provides>"
+				  "  </component>"
+				  "</components>",
+				  -1,
+				  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	fn_testing = fu_temporary_directory_build(tmpdir, "testing.xml", NULL);
+	ret = g_file_set_contents(fn_testing,
+				  "<components>"
+				  "  <component type=\"firmware\">"
+				  "    <id>testing</id>"
+				  "    <provides>"
+				  "      <firmware type=\"flashed\">"
+				  "bbbbbbbb-bbbb-cccc-dddd-eeeeeeeeeeee</firmware>"
+				  "    </provides>"
+				  "  </component>"
+				  "</components>",
+				  -1,
+				  &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	ret = fu_engine_load(engine, FU_ENGINE_LOAD_FLAG_REMOTES, progress, &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+
+	/* both remotes are in the silo, with the correct remote ID */
+	fu_device_add_instance_id(device1, "aaaaaaaa-bbbb-cccc-dddd-eeeeeeeeeeee");
+	component1 = fu_engine_get_component_by_guids(engine, device1);
+	g_assert_nonnull(component1);
+	g_assert_cmpstr(xb_node_query_text(component1,
+					   "../custom/value[@key='fwupd::RemoteId']",
+					   NULL),
+			==,
+			"stable");
+	fu_device_add_instance_id(device2, "bbbbbbbb-bbbb-cccc-dddd-eeeeeeeeeeee");
+	component2 = fu_engine_get_component_by_guids(engine, device2);
+	g_assert_nonnull(component2);
+	g_assert_cmpstr(xb_node_query_text(component2,
+					   "../custom/value[@key='fwupd::RemoteId']",
+					   NULL),
+			==,
+			"testing");
+
+	/* disabling one remote keeps the other */
+	ret = fu_engine_modify_remote(engine, "testing", "Enabled", "false", &error);
+	g_assert_no_error(error);
+	g_assert_true(ret);
+	component3 = fu_engine_get_component_by_guids(engine, device1);
+	g_assert_nonnull(component3);
+	g_assert_null(fu_engine_get_component_by_guids(engine, device2));
+}
+
 static void
 fu_engine_test_plugin_mutable_enumeration(void)
 {
@@ -1053,6 +1143,7 @@ static void
 fu_engine_downgrade_func(void)
 {
 	FwupdRelease *rel;
+	GPtrArray *releases_all;
 	gboolean ret;
 	g_autofree gchar *fn_broken = NULL;
 	g_autofree gchar *fn_stable = NULL;
@@ -1064,6 +1155,7 @@ fu_engine_downgrade_func(void)
 	g_autoptr(FuProgress) progress = fu_progress_new(G_STRLOC);
 	g_autoptr(FuTemporaryDirectory) tmpdir = NULL;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) upgrades_all = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
 	g_autoptr(GPtrArray) devices_pre = NULL;
 	g_autoptr(GPtrArray) releases_dg = NULL;
@@ -1216,6 +1308,8 @@ fu_engine_downgrade_func(void)
 	/* no upgrades, as no firmware is approved */
 	releases_up = fu_engine_get_upgrades(engine, request, fu_device_get_id(device), &error);
 	g_assert_error(error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO);
+	g_assert_nonnull(g_strstr_len(error->message, -1, "1.2.2=older"));
+	g_assert_nonnull(g_strstr_len(error->message, -1, "1.2.5=not-approved"));
 	g_assert_null(releases_up);
 	g_clear_error(&error);
 
@@ -1238,6 +1332,17 @@ fu_engine_downgrade_func(void)
 	rel = FWUPD_RELEASE(g_ptr_array_index(releases_up, 1));
 	g_assert_cmpstr(fwupd_release_get_version(rel), ==, "1.2.4");
 
+	/* upgrades for all devices */
+	upgrades_all = fu_engine_get_upgrades_all(engine, request, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(upgrades_all);
+	g_assert_cmpint(g_hash_table_size(upgrades_all), ==, 1);
+	releases_all = g_hash_table_lookup(upgrades_all, fu_device_get_id(device));
+	g_assert_nonnull(releases_all);
+	g_assert_cmpint(releases_all->len, ==, 2);
+	rel = FWUPD_RELEASE(g_ptr_array_index(releases_all, 0));
+	g_assert_cmpstr(fwupd_release_get_version(rel), ==, "1.2.5");
+
 	/* downgrades */
 	releases_dg = fu_engine_get_downgrades(engine, request, fu_device_get_id(device), &error);
 	g_assert_no_error(error);
@@ -1245,6 +1350,18 @@ fu_engine_downgrade_func(void)
 	g_assert_cmpint(releases_dg->len, ==, 1);
 	rel = FWUPD_RELEASE(g_ptr_array_index(releases_dg, 0));
 	g_assert_cmpstr(fwupd_release_get_version(rel), ==, "1.2.2");
+	g_assert_true(fwupd_release_has_flag(rel, FWUPD_RELEASE_FLAG_IS_DOWNGRADE));
+
+	/* downgrades are still found after the device version changes */
+	fu_device_set_version(device, "1.2.5");
+	g_clear_pointer(&releases_dg, g_ptr_array_unref);
+	releases_dg = fu_engine_get_downgrades(engine, request, fu_device_get_id(device), &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(releases_dg);
+	g_assert_cmpint(releases_dg->len, ==, 3);
+	rel = FWUPD_RELEASE(g_ptr_array_index(releases_dg, 0));
+	g_assert_cmpstr(fwupd_release_get_version(rel), ==, "1.2.4");
+	fu_device_set_version(device, "1.2.3");
 
 	/* enforce that updates have to be explicit */
 	fu_device_add_flag(device, FWUPD_DEVICE_FLAG_ONLY_EXPLICIT_UPDATES);
@@ -3520,6 +3637,7 @@ main(int argc, char **argv)
 			fu_plugin_engine_get_results_appstream_id_func);
 	g_test_add_func("/fwupd/engine/release-dedupe", fu_engine_release_dedupe_func);
 	g_test_add_func("/fwupd/engine/generate-md", fu_engine_generate_md_func);
+	g_test_add_func("/fwupd/engine/metadata-remotes", fu_engine_metadata_remotes_func);
 	g_test_add_func("/fwupd/engine/better-than", fu_engine_device_better_than_func);
 	g_test_add_func("/fwupd/engine/plugin/mutable", fu_engine_test_plugin_mutable_enumeration);
 	g_test_add_func("/fwupd/engine/plugin/composite", fu_engine_plugin_composite_func);
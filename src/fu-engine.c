@@ -59,6 +59,7 @@
 #include "fu-remote.h"
 #include "fu-security-attr-common.h"
 #include "fu-security-attrs-private.h"
+#include "fu-struct-trace-private.h"
 #include "fu-udev-device-private.h"
 #include "fu-uefi-backend.h"
 #include "fu-usb-backend.h"
@@ -802,21 +803,21 @@ fu_engine_get_releases_for_container_checksum(FuEngine *self, const gchar *csum)
 gchar *
 fu_engine_get_remote_id_for_stream(FuEngine *self, GInputStream *stream)
 {
-	GChecksumType checksum_types[] = {
-	    G_CHECKSUM_SHA256,
-	    G_CHECKSUM_SHA1,
+	FuDigestKind digest_kinds[] = {
+	    FU_DIGEST_KIND_SHA256,
+	    FU_DIGEST_KIND_SHA1,
 	};
+	g_autoptr(FuDigest) digest = fu_digest_new(FU_DIGEST_KIND_SHA256 | FU_DIGEST_KIND_SHA1);
 
 	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
 	g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
 
-	for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
-		g_autofree gchar *csum = NULL;
+	if (!fu_digest_update_stream(digest, stream, NULL))
+		return NULL;
+	for (guint i = 0; i < G_N_ELEMENTS(digest_kinds); i++) {
+		g_autofree gchar *csum = fu_digest_get_string(digest, digest_kinds[i]);
 		g_autoptr(GPtrArray) rels = NULL;
 
-		csum = fu_input_stream_compute_checksum(stream, checksum_types[i], NULL);
-		if (csum == NULL)
-			continue;
 		rels = fu_engine_get_releases_for_container_checksum(self, csum);
 		if (rels == NULL)
 			continue;
@@ -2784,15 +2785,16 @@ fu_engine_install_release(FuEngine *self,
 
 	/* add the checksum of the container blob if not already set */
 	if (fwupd_release_get_checksums(FWUPD_RELEASE(release))->len == 0) {
-		GChecksumType checksum_types[] = {
-		    G_CHECKSUM_SHA256,
-		    G_CHECKSUM_SHA1,
+		FuDigestKind digest_kinds[] = {
+		    FU_DIGEST_KIND_SHA256,
+		    FU_DIGEST_KIND_SHA1,
 		};
-		for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
-			g_autofree gchar *checksum =
-			    fu_input_stream_compute_checksum(stream, checksum_types[i], error);
-			if (checksum == NULL)
-				return FALSE;
+		g_autoptr(FuDigest) digest =
+		    fu_digest_new(FU_DIGEST_KIND_SHA256 | FU_DIGEST_KIND_SHA1);
+		if (!fu_digest_update_stream(digest, stream, error))
+			return FALSE;
+		for (guint i = 0; i < G_N_ELEMENTS(digest_kinds); i++) {
+			g_autofree gchar *checksum = fu_digest_get_string(digest, digest_kinds[i]);
 			fwupd_release_add_checksum(FWUPD_RELEASE(release), checksum);
 		}
 	}
@@ -3137,6 +3139,7 @@ fu_engine_prepare_firmware(FuEngine *self,
 			   GError **error)
 {
 	g_autoptr(FuDevice) device = NULL;
+	g_autoptr(FuFirmware) firmware = NULL;
 
 	/* the device and plugin both may have changed */
 	device = fu_engine_get_device(self, device_id, error);
@@ -3144,7 +3147,12 @@ fu_engine_prepare_firmware(FuEngine *self,
 		g_prefix_error_literal(error, "failed to get device before prepare firmware: ");
 		return NULL;
 	}
-	return fu_device_prepare_firmware(device, stream, progress, flags, error);
+	firmware = fu_device_prepare_firmware(device, stream, progress, flags, error);
+	if (firmware == NULL) {
+		fu_struct_trace_dump();
+		return NULL;
+	}
+	return g_steal_pointer(&firmware);
 }
 
 static gboolean
@@ -4431,10 +4439,12 @@ fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **
 	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_IGNORE_INVALID;
 	g_autoptr(GFile) xmlb = NULL;
 	g_autoptr(GPtrArray) remotes = NULL;
+	g_autoptr(GTimer) timer = g_timer_new();
 	g_autoptr(XbBuilder) builder = xb_builder_new();
+	g_autoptr(XbSilo) silo_old = NULL;
 
-	/* clear existing silo */
-	g_clear_object(&self->silo);
+	/* clear existing silo, but keep it around in case nothing changed */
+	silo_old = g_steal_pointer(&self->silo);
 
 #ifdef SOURCE_VERSION
 	/* invalidate the cache if the fwupd version changes */
@@ -4525,12 +4535,14 @@ fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **
 		return FALSE;
 	if (!fu_engine_load_metadata_store_local(self, builder, FU_PATH_KIND_DATADIR_PKG, error))
 		return FALSE;
+	g_debug("loading metadata sources took %.1fms", g_timer_elapsed(timer, NULL) * 1000.f);
 
 	/* on a read-only filesystem don't care about the cache GUID */
 	if (flags & FU_ENGINE_LOAD_FLAG_READONLY)
 		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
 
 	/* ensure silo is up to date */
+	g_timer_start(timer);
 	if (flags & FU_ENGINE_LOAD_FLAG_NO_CACHE) {
 		g_autoptr(GFileIOStream) iostr = NULL;
 		xmlb = g_file_new_tmp(NULL, &iostr, error);
@@ -4552,9 +4564,22 @@ fu_engine_load_metadata_store(FuEngine *self, FuEngineLoadFlags flags, GError **
 		g_prefix_error_literal(error, "cannot create metadata.xmlb: ");
 		return FALSE;
 	}
+	g_debug("ensuring silo took %.1fms", g_timer_elapsed(timer, NULL) * 1000.f);
+
+	/* nothing changed, so the existing indexes and prepared queries are still valid */
+	if (silo_old != NULL &&
+	    g_strcmp0(xb_silo_get_guid(silo_old), xb_silo_get_guid(self->silo)) == 0) {
+		g_debug("metadata unchanged, reusing existing silo");
+		g_set_object(&self->silo, silo_old);
+		return TRUE;
+	}
 
 	/* success */
-	return fu_engine_create_silo_index(self, error);
+	g_timer_start(timer);
+	if (!fu_engine_create_silo_index(self, error))
+		return FALSE;
+	g_debug("building silo index took %.1fms", g_timer_elapsed(timer, NULL) * 1000.f);
+	return TRUE;
 }
 
 static void
@@ -5146,10 +5171,11 @@ fu_engine_get_details(FuEngine *self,
 		      GInputStream *stream,
 		      GError **error)
 {
-	GChecksumType checksum_types[] = {
-	    G_CHECKSUM_SHA256,
-	    G_CHECKSUM_SHA1,
+	FuDigestKind digest_kinds[] = {
+	    FU_DIGEST_KIND_SHA256,
+	    FU_DIGEST_KIND_SHA1,
 	};
+	g_autoptr(FuDigest) digest = fu_digest_new(FU_DIGEST_KIND_SHA256 | FU_DIGEST_KIND_SHA1);
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(GPtrArray) details = NULL;
 	g_autoptr(GPtrArray) checksums = g_ptr_array_new_with_free_func(g_free);
@@ -5170,13 +5196,10 @@ fu_engine_get_details(FuEngine *self,
 		return NULL;
 
 	/* calculate the checksums of the blob */
-	for (guint i = 0; i < G_N_ELEMENTS(checksum_types); i++) {
-		g_autofree gchar *checksum =
-		    fu_input_stream_compute_checksum(stream, checksum_types[i], error);
-		if (checksum == NULL)
-			return NULL;
-		g_ptr_array_add(checksums, g_steal_pointer(&checksum));
-	}
+	if (!fu_digest_update_stream(digest, stream, error))
+		return NULL;
+	for (guint i = 0; i < G_N_ELEMENTS(digest_kinds); i++)
+		g_ptr_array_add(checksums, fu_digest_get_string(digest, digest_kinds[i]));
 
 	/* does this exist in any enabled remote */
 	for (guint i = 0; i < checksums->len; i++) {
@@ -5636,12 +5659,37 @@ fu_engine_check_release_is_approved(FuEngine *self, FwupdRelease *rel)
 	return FALSE;
 }
 
+/* compares the version attribute before building the FuRelease, which is expensive */
+static gboolean
+fu_engine_release_node_is_upgrade(XbNode *rel, FuDevice *device, GString *error_str)
+{
+	const gchar *version = xb_node_get_attr(rel, "version");
+	const gchar *version_device = fu_device_get_version(device);
+	gint vercmp;
+
+	/* let fu_release_load() fail or convert the version using the device */
+	if (version == NULL || version_device == NULL)
+		return TRUE;
+	if (g_strstr_len(version, -1, ".") == NULL &&
+	    fu_device_has_private_flag(device, FU_DEVICE_PRIVATE_FLAG_LAZY_VERFMT))
+		return TRUE;
+
+	vercmp = fu_version_compare(version, version_device, fu_device_get_version_format(device));
+	if (vercmp > 0)
+		return TRUE;
+	g_string_append_printf(error_str, "%s=%s, ", version, vercmp == 0 ? "same" : "older");
+	g_debug("ignoring %s %s %s", version, vercmp == 0 ? "==" : "<", version_device);
+	return FALSE;
+}
+
+/* if @error_str is set then releases that are not upgrades are skipped and added to it */
 static gboolean
 fu_engine_add_releases_for_device_component(FuEngine *self,
 					    FuEngineRequest *request,
 					    FuDevice *device,
 					    XbNode *component,
 					    GPtrArray *releases,
+					    GString *error_str,
 					    GError **error)
 {
 	FwupdFeatureFlags feature_flags;
@@ -5672,10 +5720,15 @@ fu_engine_add_releases_for_device_component(FuEngine *self,
 		gint vercmp;
 		GPtrArray *checksums;
 		GPtrArray *locations;
-		g_autoptr(FuRelease) release = fu_release_new();
+		g_autoptr(FuRelease) release = NULL;
 		g_autoptr(GError) error_loop = NULL;
 
+		/* older or the same as the device */
+		if (error_str != NULL && !fu_engine_release_node_is_upgrade(rel, device, error_str))
+			continue;
+
 		/* create new FwupdRelease for the XbNode */
+		release = fu_release_new();
 		fu_release_set_request(release, request);
 		fu_release_set_device(release, device);
 		if (!fu_engine_load_release(self,
@@ -5783,11 +5836,45 @@ fu_engine_get_branch_fallback(const gchar *nullable_branch)
 	return nullable_branch;
 }
 
-GPtrArray *
-fu_engine_get_releases_for_device(FuEngine *self,
-				  FuEngineRequest *request,
-				  FuDevice *device,
-				  GError **error)
+/* the returned array is empty if no components match */
+static GPtrArray *
+fu_engine_get_components_for_guid(FuEngine *self, const gchar *guid, GHashTable *components_cache)
+{
+	GPtrArray *components;
+	g_autoptr(GError) error_local = NULL;
+	g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
+
+	/* already queried for another device */
+	if (components_cache != NULL) {
+		components = g_hash_table_lookup(components_cache, guid);
+		if (components != NULL)
+			return g_ptr_array_ref(components);
+	}
+
+	xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
+	xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
+	components = xb_silo_query_with_context(self->silo,
+						self->query_component_by_guid,
+						&context,
+						&error_local);
+	if (components == NULL) {
+		g_debug("%s was not found: %s", guid, error_local->message);
+		components = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
+	}
+	if (components_cache != NULL)
+		g_hash_table_insert(components_cache, g_strdup(guid), g_ptr_array_ref(components));
+	return components;
+}
+
+/* if @error_str is set then only upgrades are returned, and the array may be empty;
+ * @components_cache is optional, and is used to share the silo queries between devices */
+static GPtrArray *
+fu_engine_get_releases_for_device_internal(FuEngine *self,
+					   FuEngineRequest *request,
+					   FuDevice *device,
+					   GHashTable *components_cache,
+					   GString *error_str,
+					   GError **error)
 {
 	GPtrArray *device_guids;
 	g_autoptr(GPtrArray) branches = NULL;
@@ -5840,20 +5927,11 @@ fu_engine_get_releases_for_device(FuEngine *self,
 	releases = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	for (guint j = 0; j < device_guids->len; j++) {
 		const gchar *guid = g_ptr_array_index(device_guids, j);
-		g_autoptr(GError) error_local = NULL;
 		g_autoptr(GPtrArray) components = NULL;
-		g_auto(XbQueryContext) context = XB_QUERY_CONTEXT_INIT();
 
-		xb_query_context_set_flags(&context, XB_QUERY_FLAG_USE_INDEXES);
-		xb_value_bindings_bind_str(xb_query_context_get_bindings(&context), 0, guid, NULL);
-		components = xb_silo_query_with_context(self->silo,
-							self->query_component_by_guid,
-							&context,
-							&error_local);
-		if (components == NULL) {
-			g_debug("%s was not found: %s", guid, error_local->message);
+		components = fu_engine_get_components_for_guid(self, guid, components_cache);
+		if (components->len == 0)
 			continue;
-		}
 
 		/* find all the releases that pass all the requirements */
 		g_debug("%s matched %u components", guid, components->len);
@@ -5865,6 +5943,7 @@ fu_engine_get_releases_for_device(FuEngine *self,
 									 device,
 									 component,
 									 releases,
+									 error_str,
 									 &error_tmp)) {
 				g_debug("%s", error_tmp->message);
 				continue;
@@ -5893,6 +5972,23 @@ fu_engine_get_releases_for_device(FuEngine *self,
 	if (branches->len > 1)
 		fu_device_add_flag(device, FWUPD_DEVICE_FLAG_HAS_MULTIPLE_BRANCHES);
 
+	/* success */
+	return g_steal_pointer(&releases);
+}
+
+GPtrArray *
+fu_engine_get_releases_for_device(FuEngine *self,
+				  FuEngineRequest *request,
+				  FuDevice *device,
+				  GError **error)
+{
+	g_autoptr(GPtrArray) releases = NULL;
+
+	releases =
+	    fu_engine_get_releases_for_device_internal(self, request, device, NULL, NULL, error);
+	if (releases == NULL)
+		return NULL;
+
 	/* return the compound error */
 	if (releases->len == 0) {
 		g_set_error_literal(error,
@@ -6197,37 +6293,17 @@ fu_engine_self_sign(FuEngine *self, const gchar *value, JcatSignFlags flags, GEr
 	return jcat_blob_get_data_as_string(jcat_signature);
 }
 
-/**
- * fu_engine_get_upgrades:
- * @self: a #FuEngine
- * @request: a #FuEngineRequest
- * @device_id: a device ID
- * @error: (nullable): optional return location for an error
- *
- * Gets the upgrades available for a specific device.
- *
- * Returns: (transfer container) (element-type FwupdDevice): results
- **/
-GPtrArray *
-fu_engine_get_upgrades(FuEngine *self,
-		       FuEngineRequest *request,
-		       const gchar *device_id,
-		       GError **error)
+static GPtrArray *
+fu_engine_get_upgrades_for_device(FuEngine *self,
+				  FuEngineRequest *request,
+				  FuDevice *device,
+				  GHashTable *components_cache,
+				  GError **error)
 {
-	g_autoptr(FuDevice) device = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
 	g_autoptr(GPtrArray) releases_tmp = NULL;
 	g_autoptr(GString) error_str = g_string_new(NULL);
 
-	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
-	g_return_val_if_fail(device_id != NULL, NULL);
-	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
-
-	/* find the device */
-	device = fu_device_list_get_by_id(self->device_list, device_id, error);
-	if (device == NULL)
-		return NULL;
-
 	/* there is no point checking each release */
 	if (!fu_device_is_updatable(device)) {
 		g_set_error_literal(error,
@@ -6255,10 +6331,22 @@ fu_engine_get_upgrades(FuEngine *self,
 		return NULL;
 	}
 
-	/* get all the releases for the device */
-	releases_tmp = fu_engine_get_releases_for_device(self, request, device, error);
+	/* get all the releases for the device, skipping any older or the same as the device */
+	releases_tmp = fu_engine_get_releases_for_device_internal(self,
+								  request,
+								  device,
+								  components_cache,
+								  error_str,
+								  error);
 	if (releases_tmp == NULL)
 		return NULL;
+	if (releases_tmp->len == 0 && error_str->len == 0) {
+		g_set_error_literal(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_NOTHING_TO_DO,
+				    "No releases found");
+		return NULL;
+	}
 	releases = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
 	for (guint i = 0; i < releases_tmp->len; i++) {
 		FwupdRelease *rel_tmp = g_ptr_array_index(releases_tmp, i);
@@ -6331,6 +6419,91 @@ fu_engine_get_upgrades(FuEngine *self,
 	return g_steal_pointer(&releases);
 }
 
+/**
+ * fu_engine_get_upgrades:
+ * @self: a #FuEngine
+ * @request: a #FuEngineRequest
+ * @device_id: a device ID
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the upgrades available for a specific device.
+ *
+ * Returns: (transfer container) (element-type FwupdDevice): results
+ **/
+GPtrArray *
+fu_engine_get_upgrades(FuEngine *self,
+		       FuEngineRequest *request,
+		       const gchar *device_id,
+		       GError **error)
+{
+	g_autoptr(FuDevice) device = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
+	g_return_val_if_fail(device_id != NULL, NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	/* find the device */
+	device = fu_device_list_get_by_id(self->device_list, device_id, error);
+	if (device == NULL)
+		return NULL;
+	return fu_engine_get_upgrades_for_device(self, request, device, NULL, error);
+}
+
+/**
+ * fu_engine_get_upgrades_all:
+ * @self: a #FuEngine
+ * @request: a #FuEngineRequest
+ * @error: (nullable): optional return location for an error
+ *
+ * Gets the upgrades available for all devices, sharing the metadata queries between devices
+ * with the same GUIDs. Devices without any upgrades are not included.
+ *
+ * Returns: (transfer container) (element-type utf8 GPtrArray): device ID to releases
+ **/
+GHashTable *
+fu_engine_get_upgrades_all(FuEngine *self, FuEngineRequest *request, GError **error)
+{
+	g_autoptr(GHashTable) components_cache = NULL;
+	g_autoptr(GHashTable) upgrades = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	g_return_val_if_fail(FU_IS_ENGINE(self), NULL);
+	g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+	components_cache = g_hash_table_new_full(g_str_hash,
+						 g_str_equal,
+						 g_free,
+						 (GDestroyNotify)g_ptr_array_unref);
+	upgrades = g_hash_table_new_full(g_str_hash,
+					 g_str_equal,
+					 g_free,
+					 (GDestroyNotify)g_ptr_array_unref);
+	devices = fu_device_list_get_active(self->device_list);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index(devices, i);
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) releases = NULL;
+
+		releases = fu_engine_get_upgrades_for_device(self,
+							     request,
+							     device,
+							     components_cache,
+							     &error_local);
+		if (releases == NULL) {
+			g_debug("no upgrades for %s: %s",
+				fu_device_get_id(device),
+				error_local->message);
+			continue;
+		}
+		g_hash_table_insert(upgrades,
+				    g_strdup(fu_device_get_id(device)),
+				    g_steal_pointer(&releases));
+	}
+
+	/* success */
+	return g_steal_pointer(&upgrades);
+}
+
 /**
  * fu_engine_clear_results:
  * @self: a #FuEngine
@@ -8800,6 +8973,8 @@ fu_engine_load(FuEngine *self, FuEngineLoadFlags flags, FuProgress *progress, GE
 		g_prefix_error_literal(error, "failed to load config: ");
 		return FALSE;
 	}
+	fu_history_set_write_ahead_log(self->history,
+				       fu_engine_config_get_history_write_ahead_log(self->config));
 	fu_progress_step_done(progress);
 
 	/* set the hardcoded ESP */
@@ -93,6 +93,9 @@ fu_engine_get_upgrades(FuEngine *self,
 		       FuEngineRequest *request,
 		       const gchar *device_id,
 		       GError **error) G_GNUC_NON_NULL(1, 2, 3);
+GHashTable *
+fu_engine_get_upgrades_all(FuEngine *self, FuEngineRequest *request, GError **error)
+    G_GNUC_NON_NULL(1, 2);
 FwupdDevice *
 fu_engine_get_results(FuEngine *self, const gchar *device_id, GError **error) G_GNUC_NON_NULL(1, 2);
 FuSecurityAttrs *
@@ -41,6 +41,8 @@ struct _FuHistory {
 	GObject parent_instance;
 	FuContext *ctx;
 	sqlite3 *db;
+	GHashTable *stmts; /* (element-type utf8 sqlite3_stmt) */
+	gboolean write_ahead_log;
 };
 
 G_DEFINE_TYPE(FuHistory, fu_history, G_TYPE_OBJECT)
@@ -50,6 +52,50 @@ G_DEFINE_TYPE(FuHistory, fu_history, G_TYPE_OBJECT)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(sqlite3_stmt, sqlite3_finalize);
 #pragma clang diagnostic pop
 
+/* a statement owned by the cache, which is reset rather than finalized when out of scope */
+typedef sqlite3_stmt FuHistoryCachedStmt;
+
+static void
+fu_history_cached_stmt_reset(FuHistoryCachedStmt *stmt)
+{
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuHistoryCachedStmt, fu_history_cached_stmt_reset);
+#pragma clang diagnostic pop
+
+static gint
+fu_history_prepare(FuHistory *self, const gchar *sql, FuHistoryCachedStmt **stmt)
+{
+	gint rc;
+	sqlite3_stmt *stmt_tmp;
+
+	/* reuse the compiled statement */
+	stmt_tmp = g_hash_table_lookup(self->stmts, sql);
+	if (stmt_tmp != NULL) {
+		*stmt = stmt_tmp;
+		return SQLITE_OK;
+	}
+	rc = sqlite3_prepare_v3(self->db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt_tmp, NULL);
+	if (rc != SQLITE_OK)
+		return rc;
+	g_hash_table_insert(self->stmts, g_strdup(sql), stmt_tmp);
+	*stmt = stmt_tmp;
+	return SQLITE_OK;
+}
+
+static void
+fu_history_close(FuHistory *self)
+{
+	/* the database cannot be closed with statements still open */
+	g_hash_table_remove_all(self->stmts);
+	sqlite3_close(self->db);
+	self->db = NULL;
+}
+
 static FuDevice *
 fu_history_device_from_stmt(sqlite3_stmt *stmt)
 {
@@ -595,6 +641,24 @@ fu_history_open(FuHistory *self, const gchar *filename, GError **error)
 
 	/* turn off the lookaside cache */
 	sqlite3_db_config(self->db, SQLITE_DBCONFIG_LOOKASIDE, NULL, 0, 0);
+
+	/* writes only need to be durable at each checkpoint, rather than each transaction */
+	if (self->write_ahead_log) {
+		rc = sqlite3_exec(self->db,
+				  "PRAGMA journal_mode=WAL;"
+				  "PRAGMA synchronous=NORMAL;",
+				  NULL,
+				  NULL,
+				  NULL);
+		if (rc != SQLITE_OK) {
+			g_set_error(error,
+				    FWUPD_ERROR,
+				    FWUPD_ERROR_WRITE,
+				    "failed to set journal mode: %s",
+				    sqlite3_errmsg(self->db));
+			return FALSE;
+		}
+	}
 	return TRUE;
 }
 
@@ -650,7 +714,7 @@ fu_history_load(FuHistory *self, GError **error)
 			g_warning("failed to migrate %s database: %s",
 				  filename,
 				  error_migrate->message);
-			sqlite3_close(self->db);
+			fu_history_close(self);
 			if (g_unlink(filename) != 0) {
 				g_set_error(error,
 					    FWUPD_ERROR,
@@ -710,7 +774,7 @@ fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 {
 	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -721,7 +785,7 @@ fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 
 	/* overwrite entry if it exists */
 	g_debug("modifying device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"UPDATE history SET "
 				"update_state = ?1, "
 				"update_error = ?2, "
@@ -730,9 +794,7 @@ fu_history_modify_device(FuHistory *self, FuDevice *device, GError **error)
 				"install_duration = ?8, "
 				"flags = ?3 "
 				"WHERE device_id = ?4;",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -791,7 +853,7 @@ fu_history_modify_device_release(FuHistory *self,
 	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -805,7 +867,7 @@ fu_history_modify_device_release(FuHistory *self,
 
 	/* overwrite entry if it exists */
 	g_debug("modifying device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"UPDATE history SET "
 				"update_state = ?1, "
 				"update_error = ?2, "
@@ -814,9 +876,7 @@ fu_history_modify_device_release(FuHistory *self,
 				"metadata = ?8, "
 				"flags = ?3 "
 				"WHERE device_id = ?4;",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -864,7 +924,7 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -889,7 +949,7 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 	metadata = fu_history_convert_hash_to_string(fu_release_get_metadata(release));
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"INSERT INTO history (device_id,"
 				"update_state,"
 				"update_error,"
@@ -913,9 +973,7 @@ fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GEr
 				"release_flags) "
 				"VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
 				"?11,?12,?13,?14,?15,?16,?17,?18,?19,?20,?21)",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -963,7 +1021,7 @@ gboolean
 fu_history_remove_all(FuHistory *self, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -973,7 +1031,7 @@ fu_history_remove_all(FuHistory *self, GError **error)
 
 	/* remove entries */
 	g_debug("removing all devices");
-	rc = sqlite3_prepare_v2(self->db, "DELETE FROM history;", -1, &stmt, NULL);
+	rc = fu_history_prepare(self, "DELETE FROM history;", &stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1002,7 +1060,7 @@ fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 {
 	gint rc;
 	g_autofree gchar *id_display = fu_device_get_id_display(device);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(FU_IS_DEVICE(device), FALSE);
@@ -1012,11 +1070,7 @@ fu_history_remove_device(FuHistory *self, FuDevice *device, GError **error)
 		return FALSE;
 
 	g_debug("remove device %s", id_display);
-	rc = sqlite3_prepare_v2(self->db,
-				"DELETE FROM history WHERE device_id = ?1;",
-				-1,
-				&stmt,
-				NULL);
+	rc = fu_history_prepare(self, "DELETE FROM history WHERE device_id = ?1;", &stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1046,7 +1100,7 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
 {
 	gint rc;
 	g_autoptr(GPtrArray) array_tmp = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 	g_return_val_if_fail(device_id != NULL, NULL);
@@ -1056,7 +1110,7 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
 		return NULL;
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"SELECT device_id, "
 				"checksum, "
 				"plugin, "
@@ -1080,9 +1134,7 @@ fu_history_get_device_by_id(FuHistory *self, const gchar *device_id, GError **er
 				"release_flags FROM history WHERE "
 				"device_id = ?1 ORDER BY device_created DESC "
 				"LIMIT 1",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1117,7 +1169,7 @@ GPtrArray *
 fu_history_get_devices(FuHistory *self, GError **error)
 {
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 	gint rc;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
@@ -1129,7 +1181,7 @@ fu_history_get_devices(FuHistory *self, GError **error)
 	}
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"SELECT device_id, "
 				"checksum, "
 				"plugin, "
@@ -1152,9 +1204,7 @@ fu_history_get_devices(FuHistory *self, GError **error)
 				"install_duration, "
 				"release_flags FROM history "
 				"ORDER BY device_modified ASC;",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1184,7 +1234,7 @@ fu_history_get_approved_firmware(FuHistory *self, GError **error)
 {
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func(g_free);
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1195,11 +1245,7 @@ fu_history_get_approved_firmware(FuHistory *self, GError **error)
 	}
 
 	/* get all the approved firmware */
-	rc = sqlite3_prepare_v2(self->db,
-				"SELECT checksum FROM approved_firmware;",
-				-1,
-				&stmt,
-				NULL);
+	rc = fu_history_prepare(self, "SELECT checksum FROM approved_firmware;", &stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1238,7 +1284,7 @@ gboolean
 fu_history_clear_approved_firmware(FuHistory *self, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1247,7 +1293,7 @@ fu_history_clear_approved_firmware(FuHistory *self, GError **error)
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db, "DELETE FROM approved_firmware;", -1, &stmt, NULL);
+	rc = fu_history_prepare(self, "DELETE FROM approved_firmware;", &stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1275,7 +1321,7 @@ gboolean
 fu_history_add_approved_firmware(FuHistory *self, const gchar *checksum, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(checksum != NULL, FALSE);
@@ -1285,12 +1331,10 @@ fu_history_add_approved_firmware(FuHistory *self, const gchar *checksum, GError
 		return FALSE;
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"INSERT INTO approved_firmware (checksum) "
 				"VALUES (?1)",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1310,7 +1354,7 @@ fu_history_add_security_attribute(FuHistory *self,
 				  GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1319,12 +1363,10 @@ fu_history_add_security_attribute(FuHistory *self,
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"INSERT INTO hsi_history (hsi_details, hsi_score)"
 				"VALUES (?1, ?2)",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1357,7 +1399,7 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 	gint rc;
 	guint old_hash = 0;
 	g_autoptr(GPtrArray) array = g_ptr_array_new_with_free_func((GDestroyNotify)g_object_unref);
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), NULL);
 
@@ -1368,12 +1410,10 @@ fu_history_get_security_attrs(FuHistory *self, guint limit, GError **error)
 	}
 
 	/* get all the devices */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"SELECT timestamp, hsi_details FROM hsi_history "
 				"ORDER BY timestamp DESC;",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1458,7 +1498,7 @@ gboolean
 fu_history_has_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 
@@ -1470,18 +1510,14 @@ fu_history_has_emulation_tag(FuHistory *self, const gchar *device_id, GError **e
 
 	/* get tagged device ID */
 	if (device_id != NULL) {
-		rc = sqlite3_prepare_v2(self->db,
+		rc = fu_history_prepare(self,
 					"SELECT device_id FROM emulation_tag "
 					"WHERE device_id = ?1 LIMIT 1;",
-					-1,
-					&stmt,
-					NULL);
+					&stmt);
 	} else {
-		rc = sqlite3_prepare_v2(self->db,
+		rc = fu_history_prepare(self,
 					"SELECT device_id FROM emulation_tag LIMIT 1;",
-					-1,
-					&stmt,
-					NULL);
+					&stmt);
 	}
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
@@ -1537,7 +1573,7 @@ gboolean
 fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(device_id != NULL, FALSE);
@@ -1547,12 +1583,10 @@ fu_history_add_emulation_tag(FuHistory *self, const gchar *device_id, GError **e
 		return FALSE;
 
 	/* add */
-	rc = sqlite3_prepare_v2(self->db,
+	rc = fu_history_prepare(self,
 				"INSERT INTO emulation_tag (device_id) "
 				"VALUES (?1)",
-				-1,
-				&stmt,
-				NULL);
+				&stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1580,7 +1614,7 @@ gboolean
 fu_history_remove_emulation_tag(FuHistory *self, const gchar *device_id, GError **error)
 {
 	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryCachedStmt) stmt = NULL;
 
 	g_return_val_if_fail(FU_IS_HISTORY(self), FALSE);
 	g_return_val_if_fail(device_id != NULL, FALSE);
@@ -1590,11 +1624,7 @@ fu_history_remove_emulation_tag(FuHistory *self, const gchar *device_id, GError
 		return FALSE;
 
 	/* remove entries */
-	rc = sqlite3_prepare_v2(self->db,
-				"DELETE FROM emulation_tag WHERE device_id = ?1;",
-				-1,
-				&stmt,
-				NULL);
+	rc = fu_history_prepare(self, "DELETE FROM emulation_tag WHERE device_id = ?1;", &stmt);
 	if (rc != SQLITE_OK) {
 		g_set_error(error,
 			    FWUPD_ERROR,
@@ -1607,6 +1637,25 @@ fu_history_remove_emulation_tag(FuHistory *self, const gchar *device_id, GError
 	return fu_history_stmt_exec(self, stmt, NULL, error);
 }
 
+/**
+ * fu_history_set_write_ahead_log:
+ * @self: a #FuHistory
+ * @write_ahead_log: boolean
+ *
+ * Sets if the database should use a write-ahead log rather than a rollback journal, which is
+ * faster but is only synced to disk at each checkpoint.
+ *
+ * This only takes effect when the database is next opened.
+ *
+ * Since: 2.1.2
+ **/
+void
+fu_history_set_write_ahead_log(FuHistory *self, gboolean write_ahead_log)
+{
+	g_return_if_fail(FU_IS_HISTORY(self));
+	self->write_ahead_log = write_ahead_log;
+}
+
 static void
 fu_history_housekeeping_cb(FuContext *ctx, FuHistory *self)
 {
@@ -1636,6 +1685,8 @@ fu_history_class_init(FuHistoryClass *klass)
 static void
 fu_history_init(FuHistory *self)
 {
+	self->stmts =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)sqlite3_finalize);
 }
 
 static void
@@ -1643,7 +1694,8 @@ fu_history_finalize(GObject *object)
 {
 	FuHistory *self = FU_HISTORY(object);
 	if (self->db != NULL)
-		sqlite3_close(self->db);
+		fu_history_close(self);
+	g_hash_table_unref(self->stmts);
 	G_OBJECT_CLASS(fu_history_parent_class)->finalize(object);
 }
 
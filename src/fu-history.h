@@ -15,6 +15,8 @@ G_DECLARE_FINAL_TYPE(FuHistory, fu_history, FU, HISTORY, GObject)
 
 FuHistory *
 fu_history_new(FuContext *ctx);
+void
+fu_history_set_write_ahead_log(FuHistory *self, gboolean write_ahead_log) G_GNUC_NON_NULL(1);
 
 gboolean
 fu_history_add_device(FuHistory *self, FuDevice *device, FuRelease *release, GError **error)
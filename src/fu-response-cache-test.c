@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "fu-response-cache.h"
+
+static void
+fu_response_cache_func(void)
+{
+	g_autoptr(FuResponseCache) response_cache = fu_response_cache_new();
+	g_autoptr(GVariant) val1 = NULL;
+	g_autoptr(GVariant) val2 = NULL;
+	g_autoptr(GVariant) val3 = NULL;
+	g_autoptr(GVariant) val4 = NULL;
+
+	/* nothing cached */
+	val1 = fu_response_cache_lookup(response_cache, "GetUpgrades(abc)");
+	g_assert_null(val1);
+
+	/* an identical request shares the same value */
+	fu_response_cache_add_value(response_cache,
+				    "GetUpgrades(abc)",
+				    g_variant_new("(u)", (guint32)123));
+	val1 = fu_response_cache_lookup(response_cache, "GetUpgrades(abc)");
+	g_assert_nonnull(val1);
+	val2 = fu_response_cache_lookup(response_cache, "GetUpgrades(abc)");
+	g_assert_nonnull(val2);
+	g_assert_true(val1 == val2);
+	g_assert_false(g_variant_is_floating(val1));
+	g_assert_cmpint(fu_response_cache_get_hits(response_cache), ==, 2);
+	g_assert_cmpint(fu_response_cache_get_misses(response_cache), ==, 1);
+
+	/* device changed */
+	fu_response_cache_invalidate(response_cache);
+	g_assert_cmpint(fu_response_cache_get_generation(response_cache), ==, 1);
+	val3 = fu_response_cache_lookup(response_cache, "GetUpgrades(abc)");
+	g_assert_null(val3);
+	g_assert_cmpint(fu_response_cache_get_misses(response_cache), ==, 2);
+
+	/* stale items are dropped when full */
+	for (guint i = 0; i < 64; i++) {
+		g_autofree gchar *key = g_strdup_printf("GetUpgrades(%u)", i);
+		fu_response_cache_add_value(response_cache, key, g_variant_new("(u)", i));
+	}
+	g_assert_cmpint(fu_response_cache_get_size(response_cache), ==, 64);
+	val4 = fu_response_cache_lookup(response_cache, "GetUpgrades(63)");
+	g_assert_nonnull(val4);
+
+	/* and then everything when each request is unique */
+	fu_response_cache_add_value(response_cache,
+				    "GetUpgrades(xyz)",
+				    g_variant_new("(u)", (guint32)456));
+	g_assert_cmpint(fu_response_cache_get_size(response_cache), ==, 1);
+}
+
+int
+main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+	g_test_add_func("/fwupd/response-cache", fu_response_cache_func);
+	return g_test_run();
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#define G_LOG_DOMAIN "FuResponseCache"
+
+#include "config.h"
+
+#include "fu-response-cache.h"
+
+struct _FuResponseCache {
+	GObject parent_instance;
+	GHashTable *items; /* (element-type utf8 FuResponseCacheItem) */
+	guint64 generation;
+	guint hits;
+	guint misses;
+};
+
+typedef struct {
+	guint64 generation;
+	GVariant *value;
+} FuResponseCacheItem;
+
+G_DEFINE_TYPE(FuResponseCache, fu_response_cache, G_TYPE_OBJECT)
+
+/* each device ID and locale is a different key */
+#define FU_RESPONSE_CACHE_ITEMS_MAX 64
+
+static void
+fu_response_cache_item_free(FuResponseCacheItem *item)
+{
+	g_variant_unref(item->value);
+	g_free(item);
+}
+
+/* this is called for every device change, so the items are only expired on next lookup */
+void
+fu_response_cache_invalidate(FuResponseCache *self)
+{
+	g_return_if_fail(FU_IS_RESPONSE_CACHE(self));
+	self->generation++;
+}
+
+/* returns the original response, or %NULL if not found or the response is stale */
+GVariant *
+fu_response_cache_lookup(FuResponseCache *self, const gchar *key)
+{
+	FuResponseCacheItem *item;
+
+	g_return_val_if_fail(FU_IS_RESPONSE_CACHE(self), NULL);
+	g_return_val_if_fail(key != NULL, NULL);
+
+	item = g_hash_table_lookup(self->items, key);
+	if (item == NULL || item->generation != self->generation) {
+		self->misses++;
+		return NULL;
+	}
+	self->hits++;
+	return g_variant_ref(item->value);
+}
+
+static gboolean
+fu_response_cache_item_is_stale_cb(gpointer key, gpointer value, gpointer user_data)
+{
+	FuResponseCache *self = FU_RESPONSE_CACHE(user_data);
+	FuResponseCacheItem *item = (FuResponseCacheItem *)value;
+	return item->generation != self->generation;
+}
+
+/* errors are never cached as they may be transient */
+void
+fu_response_cache_add_value(FuResponseCache *self, const gchar *key, GVariant *value)
+{
+	FuResponseCacheItem *item;
+
+	g_return_if_fail(FU_IS_RESPONSE_CACHE(self));
+	g_return_if_fail(key != NULL);
+	g_return_if_fail(value != NULL);
+
+	/* drop the stale items first, and then everything if a client is using unique keys */
+	if (g_hash_table_size(self->items) >= FU_RESPONSE_CACHE_ITEMS_MAX) {
+		g_hash_table_foreach_remove(self->items, fu_response_cache_item_is_stale_cb, self);
+		if (g_hash_table_size(self->items) >= FU_RESPONSE_CACHE_ITEMS_MAX)
+			g_hash_table_remove_all(self->items);
+	}
+
+	item = g_new0(FuResponseCacheItem, 1);
+	item->generation = self->generation;
+	item->value = g_variant_ref_sink(value);
+	g_hash_table_insert(self->items, g_strdup(key), item);
+}
+
+guint
+fu_response_cache_get_size(FuResponseCache *self)
+{
+	g_return_val_if_fail(FU_IS_RESPONSE_CACHE(self), G_MAXUINT);
+	return g_hash_table_size(self->items);
+}
+
+guint64
+fu_response_cache_get_generation(FuResponseCache *self)
+{
+	g_return_val_if_fail(FU_IS_RESPONSE_CACHE(self), G_MAXUINT64);
+	return self->generation;
+}
+
+guint
+fu_response_cache_get_hits(FuResponseCache *self)
+{
+	g_return_val_if_fail(FU_IS_RESPONSE_CACHE(self), G_MAXUINT);
+	return self->hits;
+}
+
+guint
+fu_response_cache_get_misses(FuResponseCache *self)
+{
+	g_return_val_if_fail(FU_IS_RESPONSE_CACHE(self), G_MAXUINT);
+	return self->misses;
+}
+
+static void
+fu_response_cache_init(FuResponseCache *self)
+{
+	self->items = g_hash_table_new_full(g_str_hash,
+					    g_str_equal,
+					    g_free,
+					    (GDestroyNotify)fu_response_cache_item_free);
+}
+
+static void
+fu_response_cache_finalize(GObject *obj)
+{
+	FuResponseCache *self = FU_RESPONSE_CACHE(obj);
+	g_hash_table_unref(self->items);
+	G_OBJECT_CLASS(fu_response_cache_parent_class)->finalize(obj);
+}
+
+static void
+fu_response_cache_class_init(FuResponseCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->finalize = fu_response_cache_finalize;
+}
+
+FuResponseCache *
+fu_response_cache_new(void)
+{
+	FuResponseCache *self;
+	self = g_object_new(FU_TYPE_RESPONSE_CACHE, NULL);
+	return FU_RESPONSE_CACHE(self);
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2026 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <fwupdplugin.h>
+
+#define FU_TYPE_RESPONSE_CACHE (fu_response_cache_get_type())
+G_DECLARE_FINAL_TYPE(FuResponseCache, fu_response_cache, FU, RESPONSE_CACHE, GObject)
+
+FuResponseCache *
+fu_response_cache_new(void);
+void
+fu_response_cache_invalidate(FuResponseCache *self) G_GNUC_NON_NULL(1);
+GVariant *
+fu_response_cache_lookup(FuResponseCache *self, const gchar *key) G_GNUC_NON_NULL(1, 2);
+void
+fu_response_cache_add_value(FuResponseCache *self, const gchar *key, GVariant *value)
+    G_GNUC_NON_NULL(1, 2, 3);
+guint
+fu_response_cache_get_size(FuResponseCache *self) G_GNUC_NON_NULL(1);
+guint64
+fu_response_cache_get_generation(FuResponseCache *self) G_GNUC_NON_NULL(1);
+guint
+fu_response_cache_get_hits(FuResponseCache *self) G_GNUC_NON_NULL(1);
+guint
+fu_response_cache_get_misses(FuResponseCache *self) G_GNUC_NON_NULL(1);
@@ -37,6 +37,7 @@
 #include "fu-plugin-private.h"
 #include "fu-security-attrs-private.h"
 #include "fu-smbios-private.h"
+#include "fu-struct-trace-private.h"
 #include "fu-util-bios-setting.h"
 #include "fu-util-common.h"
 
@@ -2499,6 +2500,7 @@ fu_util_tpm_eventlog(FuUtil *self, gchar **values, GError **error)
 	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(GInputStream) stream = NULL;
 	g_autoptr(GPtrArray) items = NULL;
+	g_autoptr(GPtrArray) pcrs_all = NULL;
 	g_autoptr(GString) str = g_string_new(NULL);
 
 	/* optional PCR */
@@ -2552,11 +2554,9 @@ fu_util_tpm_eventlog(FuUtil *self, gchar **values, GError **error)
 		return FALSE;
 	}
 	fwupd_codec_string_append(str, 0, "Reconstructed PCRs", "");
-	for (guint8 i = 0; i <= max_pcr; i++) {
-		g_autoptr(GPtrArray) pcrs =
-		    fu_tpm_eventlog_calc_checksums(FU_TPM_EVENTLOG(eventlog), i, NULL);
-		if (pcrs == NULL)
-			continue;
+	pcrs_all = fu_tpm_eventlog_calc_checksums_all(FU_TPM_EVENTLOG(eventlog), NULL);
+	for (guint8 i = 0; pcrs_all != NULL && i <= max_pcr && i < pcrs_all->len; i++) {
+		GPtrArray *pcrs = g_ptr_array_index(pcrs_all, i);
 		for (guint j = 0; j < pcrs->len; j++) {
 			const gchar *csum = g_ptr_array_index(pcrs, j);
 			g_autofree gchar *title = NULL;
@@ -2577,9 +2577,9 @@ fu_util_tpm_eventlog(FuUtil *self, gchar **values, GError **error)
 static gboolean
 fu_util_crc_find(FuUtil *self, gchar **values, GError **error)
 {
-	FuCrcKind kind;
 	guint64 crc_target = 0;
-	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GArray) kinds = NULL;
+	g_autoptr(GInputStream) stream = NULL;
 
 	/* sanity check */
 	if (g_strv_length(values) < 2) {
@@ -2594,17 +2594,17 @@ fu_util_crc_find(FuUtil *self, gchar **values, GError **error)
 	if (!fu_strtoull(values[0], &crc_target, 0, G_MAXUINT32, FU_INTEGER_BASE_AUTO, error))
 		return FALSE;
 
-	/* find the first CRC that matches */
-	blob = fu_bytes_get_contents(values[1], error);
-	if (blob == NULL)
+	/* find all the CRCs that match in one pass */
+	stream = fu_input_stream_from_path(values[1], error);
+	if (stream == NULL)
 		return FALSE;
-	if (!fu_crc_find(g_bytes_get_data(blob, NULL),
-			 g_bytes_get_size(blob),
-			 crc_target,
-			 &kind,
-			 error))
+	kinds = fu_input_stream_find_crc_kinds(stream, (guint32)crc_target, error);
+	if (kinds == NULL)
 		return FALSE;
-	fu_console_print_literal(self->console, fu_crc_kind_to_string(kind));
+	for (guint i = 0; i < kinds->len; i++) {
+		FuCrcKind kind = g_array_index(kinds, FuCrcKind, i);
+		fu_console_print_literal(self->console, fu_crc_kind_to_string(kind));
+	}
 
 	/* success */
 	return TRUE;
@@ -3355,8 +3355,10 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 					      stream,
 					      0x0,
 					      self->parse_flags,
-					      error))
+					      error)) {
+			fu_struct_trace_dump();
 			return FALSE;
+		}
 		imgs = fu_firmware_get_images(firmware_linear);
 		if (imgs->len == 1) {
 			g_set_object(&firmware, g_ptr_array_index(imgs, 0));
@@ -3364,8 +3366,10 @@ fu_util_firmware_parse(FuUtil *self, gchar **values, GError **error)
 			g_set_object(&firmware, firmware_linear);
 		}
 	} else {
-		if (!fu_firmware_parse_stream(firmware, stream, 0x0, self->parse_flags, error))
+		if (!fu_firmware_parse_stream(firmware, stream, 0x0, self->parse_flags, error)) {
+			fu_struct_trace_dump();
 			return FALSE;
+		}
 	}
 
 	str = fu_firmware_to_string(firmware);